@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "corpus.h"
+#include "parser.h"
+#include "solver.h"
+
+
+namespace sudoku
+{
+
+namespace bench
+{
+
+/** Solve every board of every corpus with every engine, one at a time, and
+ *  report the throughput and the distribution of the latency of a single
+ *  solve, measured from loading the board to getting its solution. */
+class Benchmark
+{
+public:
+    struct Result
+    {
+        std::string corpus;
+        std::string engine;
+        size_t numBoards = 0;
+        size_t numSolved = 0;
+        double seconds = 0.0;
+        double p50 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+    };
+
+    Benchmark(size_t count, std::uint64_t seed): count(count), seed(seed)
+    {}
+
+    std::vector<Result> run() const
+    {
+        static const Configuration configurations[] = {
+            {"propagation", Solver::Engine::Propagation, Solver::Techniques()},
+            {"techniques", Solver::Engine::Propagation, Solver::Techniques::all()},
+            {"dlx", Solver::Engine::DancingLinks, Solver::Techniques()},
+        };
+
+        std::vector<Result> results;
+        for (const auto& corpus: generateCorpora(count, seed)) {
+            const auto states = parse(corpus);
+            for (const auto& configuration: configurations) {
+                results.push_back(measure(corpus.name, configuration, states));
+            }
+        }
+        return results;
+    }
+
+private:
+    /** A way to run the solver, reported as an "engine". */
+    struct Configuration
+    {
+        const char* name;
+        Solver::Engine engine;
+        Solver::Techniques techniques;
+    };
+
+    // boards solved before measuring, to warm up the caches and the branch predictors
+    static constexpr size_t warmupBoards = 50;
+
+    static std::vector<types::state_t> parse(const Corpus& corpus)
+    {
+        std::vector<types::state_t> states(corpus.boards.size());
+        parser::Error error;
+        for (size_t i = 0; i < states.size(); ++i) {
+            parser::parseLine(corpus.boards[i], states[i], error);
+        }
+        return states;
+    }
+
+    static bool solve(Solver& solver, const types::state_t& state)
+    {
+        solver.load(state);
+        try {
+            solver.solve();
+            return true;
+        } catch (const Solver::NoSolution&) {
+            return false;
+        }
+    }
+
+    /** The latency below which a `fraction` of the sorted `latencies` lie. */
+    static double percentile(const std::vector<double>& latencies, double fraction)
+    {
+        const auto index = static_cast<size_t>(fraction * (latencies.size() - 1) + 0.5);
+        return latencies[index];
+    }
+
+    static Result measure(const std::string& corpus, const Configuration& configuration,
+        const std::vector<types::state_t>& states)
+    {
+        Solver solver(configuration.engine);
+        solver.setTechniques(configuration.techniques);
+        for (size_t i = 0; i < std::min(warmupBoards, states.size()); ++i) {
+            solve(solver, states[i]);
+        }
+
+        Result result;
+        result.corpus = corpus;
+        result.engine = configuration.name;
+        result.numBoards = states.size();
+
+        std::vector<double> latencies;
+        latencies.reserve(states.size());
+        for (const auto& state: states) {
+            const auto start = std::chrono::steady_clock::now();
+            result.numSolved += solve(solver, state);
+            const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+            latencies.push_back(elapsed.count());
+            result.seconds += elapsed.count();
+        }
+
+        if (!latencies.empty()) {
+            std::sort(latencies.begin(), latencies.end());
+            result.p50 = percentile(latencies, 0.50);
+            result.p99 = percentile(latencies, 0.99);
+            result.max = latencies.back();
+        }
+        return result;
+    }
+
+    size_t count;
+    std::uint64_t seed;
+};
+
+static double boardsPerSecond(const Benchmark::Result& result)
+{
+    return (result.seconds > 0.0) ? result.numBoards / result.seconds : 0.0;
+}
+
+static void printTable(const std::vector<Benchmark::Result>& results)
+{
+    std::cout << std::left << std::setw(12) << "corpus" << std::setw(13) << "engine" << std::right
+        << std::setw(8) << "boards" << std::setw(8) << "solved" << std::setw(14) << "boards/s"
+        << std::setw(12) << "p50 (us)" << std::setw(12) << "p99 (us)" << std::setw(12) << "max (us)" << '\n';
+    std::cout << std::fixed;
+    for (const auto& result: results) {
+        std::cout << std::left << std::setw(12) << result.corpus << std::setw(13) << result.engine << std::right
+            << std::setw(8) << result.numBoards << std::setw(8) << result.numSolved
+            << std::setw(14) << std::setprecision(0) << boardsPerSecond(result) << std::setprecision(1)
+            << std::setw(12) << result.p50 * 1e6 << std::setw(12) << result.p99 * 1e6
+            << std::setw(12) << result.max * 1e6 << '\n';
+    }
+}
+
+static void writeJson(std::ostream& output, const std::vector<Benchmark::Result>& results, size_t count,
+    std::uint64_t seed)
+{
+    output << "{\n  \"count\": " << count << ",\n  \"seed\": " << seed << ",\n  \"results\": [";
+    output << std::setprecision(9);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& result = results[i];
+        output << (i ? "," : "") << "\n    {\"corpus\": \"" << result.corpus << "\", \"engine\": \""
+            << result.engine << "\", \"boards\": " << result.numBoards << ", \"solved\": " << result.numSolved
+            << ", \"seconds\": " << result.seconds << ", \"boards_per_second\": " << boardsPerSecond(result)
+            << ", \"p50_seconds\": " << result.p50 << ", \"p99_seconds\": " << result.p99
+            << ", \"max_seconds\": " << result.max << "}";
+    }
+    output << "\n  ]\n}\n";
+}
+
+template<typename T>
+static bool parseOption(const char* arg, const char* name, T& value)
+{
+    const auto length = std::strlen(name);
+    if (std::strncmp(arg, name, length) != 0) {
+        return false;
+    }
+    const auto text = arg + length;
+    const auto end = text + std::strlen(text);
+    const auto [last, error] = std::from_chars(text, end, value);
+    return (error == std::errc()) && (last == end);
+}
+
+}  // namespace bench
+
+}  // namespace sudoku
+
+int main(int argc, char* argv[])
+{
+    using namespace sudoku::bench;
+
+    size_t count = 1000;
+    std::uint64_t seed = 1;
+    std::string jsonPath;
+    for (int i = 1; i < argc; ++i) {
+        const auto arg = argv[i];
+        if (std::strncmp(arg, "--json=", 7) == 0) {
+            jsonPath = arg + 7;
+        } else if (!parseOption(arg, "--count=", count) && !parseOption(arg, "--seed=", seed)) {
+            std::cerr << "Usage: " << argv[0] << " [--count=N] [--seed=N] [--json=FILE]\n";
+            return 1;
+        }
+    }
+
+    const auto results = Benchmark(count, seed).run();
+    printTable(results);
+
+    if (!jsonPath.empty()) {
+        std::ofstream json(jsonPath);
+        writeJson(json, results, count, seed);
+        if (!json) {
+            std::cerr << "Can't write " << jsonPath << '\n';
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <random>
+
+#include "constants.h"
+#include "corpus.h"
+#include "solver.h"
+
+
+namespace sudoku
+{
+
+namespace bench
+{
+
+namespace
+{
+
+using constants::boxSize;
+using constants::numColumns;
+using constants::numElements;
+using constants::numRows;
+using constants::numValues;
+
+// puzzles that need a lot of search, among them Arto Inkala's and AI Escargot
+const std::array hardSeeds = {
+    "8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4..",
+    "1....7.9..3..2...8..96..5....53..9...1..8...26....4...3......1..4......7..7...3..",
+    "..53.....8......2..7..1.5..4....53...1..7...6..32...8..6.5....9..4....3......97..",
+    "12.3....435....1....4........54..2..6...7.........8.9...31..5.......9.7.....6...8",
+    "1.......2.9.4...5...6...7...5.9.3.......7.......85..4.7.....6...3...9.8...2.....1",
+};
+
+// puzzles with the minimum number of givens for a unique solution
+const std::array minimalSeeds = {
+    ".......1.4.........2...........5.4.7..8...3....1.9....3..4..2...5.1........8.6...",
+    ".......1.4.........2...........5.6.4..8...3....1.9....3..4..2...5.1........8.7...",
+    ".......12....35......6...7.7.....3.....4..8..1...........12.....8.....4..5....6..",
+    ".......12..36..........7...41..2.......5..3..7.....6..28.....4....3..5...........",
+    "4.....8.5.3..........7......2.....6.....8.4......1.......6.3.7.5..2.....1.4......",
+    "52...6.........7.13...........4..8..6......5...........418.........3..2...87.....",
+    "6.....8.3.4.7.................5.4.7.3..2.....1.6.......2.....5.....8.6......1....",
+    "48.3............71.2.......7.5....6....2..8.............1.76...3.....4......5....",
+};
+
+// givens of the easy boards, enough for propagation alone to solve most of them
+const size_t easyGivens = 36;
+
+class Generator
+{
+public:
+    explicit Generator(std::uint64_t seed): random(seed)
+    {}
+
+    /** A number in [0, bound), the same on every standard library. */
+    size_t below(size_t bound)
+    {
+        return random() % bound;
+    }
+
+    template<typename Container>
+    void shuffle(Container& container)
+    {
+        for (auto i = container.size(); i > 1; --i) {
+            std::swap(container[i - 1], container[below(i)]);
+        }
+    }
+
+    /** A random permutation of 0..boxSize-1 for each group of boxSize lines. */
+    std::array<size_t, numRows> linePermutation()
+    {
+        std::array<size_t, boxSize> groups;
+        std::iota(groups.begin(), groups.end(), 0);
+        shuffle(groups);
+
+        std::array<size_t, numRows> lines;
+        for (size_t group = 0; group < boxSize; ++group) {
+            std::array<size_t, boxSize> offsets;
+            std::iota(offsets.begin(), offsets.end(), 0);
+            shuffle(offsets);
+            for (size_t i = 0; i < boxSize; ++i) {
+                lines[group * boxSize + i] = groups[group] * boxSize + offsets[i];
+            }
+        }
+        return lines;
+    }
+
+    /** Relabel the values, permute the bands, stacks, rows and columns and
+     *  maybe transpose: the result has as many solutions as `board`. */
+    std::string transform(const std::string& board)
+    {
+        std::array<char, numValues> values;
+        std::iota(values.begin(), values.end(), '1');
+        shuffle(values);
+        const auto rows = linePermutation();
+        const auto columns = linePermutation();
+        const auto transpose = below(2) == 1;
+
+        std::string result(numElements, '.');
+        for (size_t i = 0; i < numRows; ++i) {
+            for (size_t j = 0; j < numColumns; ++j) {
+                const auto ch = transpose ? board[columns[j] * numColumns + rows[i]]
+                    : board[rows[i] * numColumns + columns[j]];
+                if (ch != '.') {
+                    result[i * numColumns + j] = values[ch - '1'];
+                }
+            }
+        }
+        return result;
+    }
+
+    template<typename Seeds>
+    std::string pick(const Seeds& seeds)
+    {
+        return transform(seeds[below(seeds.size())]);
+    }
+
+private:
+    std::mt19937_64 random;
+};
+
+std::string solve(const std::string& board)
+{
+    Solver::board_t rows(numRows);
+    for (size_t i = 0; i < numRows; ++i) {
+        rows[i].assign(board.begin() + i * numColumns, board.begin() + (i + 1) * numColumns);
+    }
+
+    std::string solution;
+    for (const auto& row: Solver(rows).solve()) {
+        solution.append(row.begin(), row.end());
+    }
+    return solution;
+}
+
+std::vector<size_t> unknownCells(const std::string& board)
+{
+    std::vector<size_t> cells;
+    for (size_t i = 0; i < numElements; ++i) {
+        if (board[i] == '.') {
+            cells.push_back(i);
+        }
+    }
+    return cells;
+}
+
+/** A minimal puzzle with givens of its solution added until it is easy. */
+std::string makeEasy(Generator& generator)
+{
+    auto board = generator.pick(minimalSeeds);
+    const auto solution = solve(board);
+    auto cells = unknownCells(board);
+    generator.shuffle(cells);
+    cells.resize(cells.size() - (easyGivens - (numElements - cells.size())));
+    for (auto cell: cells) {
+        board[cell] = solution[cell];
+    }
+    return board;
+}
+
+bool isPeer(size_t a, size_t b)
+{
+    const auto rowA = a / numColumns, columnA = a % numColumns;
+    const auto rowB = b / numColumns, columnB = b % numColumns;
+    return (rowA == rowB) || (columnA == columnB)
+        || ((rowA / boxSize == rowB / boxSize) && (columnA / boxSize == columnB / boxSize));
+}
+
+/** A puzzle with a unique solution and one more given that contradicts it
+ *  but none of the givens of its peers, so the conflict only shows up
+ *  after some solving. */
+std::string makeUnsolvable(Generator& generator)
+{
+    auto board = (generator.below(2) == 0) ? generator.pick(hardSeeds) : generator.pick(minimalSeeds);
+    const auto solution = solve(board);
+    auto cells = unknownCells(board);
+    generator.shuffle(cells);
+    for (auto cell: cells) {
+        for (char value = '1'; value <= constants::maxValue; ++value) {
+            if (value == solution[cell]) {
+                continue;
+            }
+            auto conflict = false;
+            for (size_t peer = 0; (peer < numElements) && !conflict; ++peer) {
+                conflict = (peer != cell) && (board[peer] == value) && isPeer(cell, peer);
+            }
+            if (!conflict) {
+                board[cell] = value;
+                return board;
+            }
+        }
+    }
+    return board;
+}
+
+}  // namespace
+
+std::vector<Corpus> generateCorpora(size_t count, std::uint64_t seed)
+{
+    Generator generator(seed);
+    std::vector<Corpus> corpora = {{"easy", {}}, {"hard", {}}, {"17-clue", {}}, {"unsolvable", {}}};
+    for (auto& corpus: corpora) {
+        corpus.boards.reserve(count);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        corpora[0].boards.push_back(makeEasy(generator));
+        corpora[1].boards.push_back(generator.pick(hardSeeds));
+        corpora[2].boards.push_back(generator.pick(minimalSeeds));
+        corpora[3].boards.push_back(makeUnsolvable(generator));
+    }
+    return corpora;
+}
+
+}  // namespace bench
+
+}  // namespace sudoku
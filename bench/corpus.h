@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace sudoku
+{
+
+namespace bench
+{
+
+/** A named set of boards in the format of 81 characters, '.' for an unknown cell. */
+struct Corpus
+{
+    std::string name;
+    std::vector<std::string> boards;
+};
+
+/** Generate the corpora of the benchmark: "easy", "hard", "17-clue" and
+ *  "unsolvable", `count` boards each.
+ *
+ *  Every board is a well-known puzzle with a unique solution, relabelled
+ *  and shuffled by transformations that keep both its solution count and
+ *  its difficulty. The same seed gives the same boards on every machine. */
+std::vector<Corpus> generateCorpora(size_t count, std::uint64_t seed);
+
+}  // namespace bench
+
+}  // namespace sudoku
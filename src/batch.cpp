@@ -0,0 +1,318 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "batch.h"
+#include "constants.h"
+#include "display.h"
+#include "input.h"
+#include "lane_solver.h"
+#include "parser.h"
+#include "solution_cache.h"
+#include "thread_pool.h"
+
+
+namespace sudoku
+{
+
+struct Batch::Private
+{
+    // lines read from a stream for a single task of the thread pool
+    static const size_t chunkLines = 512;
+    // bytes of an in-memory input for a single task, about as many lines
+    static const size_t chunkBytes = chunkLines * (constants::numElements + 1);
+    // chunks that may be read ahead of the first unfinished one, per worker
+    static const size_t chunksInFlightPerWorker = 4;
+
+    struct Counters
+    {
+        size_t numBoards = 0;
+        size_t numSolved = 0;
+        size_t numUnsolvable = 0;
+        size_t numInvalid = 0;
+        Solver::Stats stats;
+
+        Counters& operator+=(const Counters& other)
+        {
+            numBoards += other.numBoards;
+            numSolved += other.numSolved;
+            numUnsolvable += other.numUnsolvable;
+            numInvalid += other.numInvalid;
+            stats += other.stats;
+            return *this;
+        }
+    };
+
+    /** Everything a worker needs to solve a line, reused from line to line. */
+    struct Worker
+    {
+        Worker(const Options& options, SolutionCache* cache): solver(options.engine), useLanes(options.useLanes),
+            cache(cache)
+        {
+            solver.setTechniques(options.techniques);
+        }
+
+        Solver solver;
+        Solver::board_t board;
+        bool useLanes;
+        SolutionCache* cache;
+        LaneSolver lanes;
+        types::state_t state;
+        // the parsed boards of the lanes, the keys of the cache
+        std::array<types::state_t, LaneSolver::numLanes> givens;
+        parser::Error error;
+    };
+
+    struct Chunk
+    {
+        // the lines read from a stream, `text` points into it
+        std::string buffer;
+        std::string_view text;
+        std::string output;
+        Counters counters;
+    };
+
+    /** Parse a line into `worker.state`, straight from the text for the
+     *  format of 81 characters. */
+    static bool parse(Worker& worker, std::string_view line)
+    {
+        if (parser::isLineFormat(line)) {
+            return parser::parseLine(line, worker.state, worker.error);
+        }
+        if (!parser::parseBoard(line, worker.board, worker.error) || (worker.board.size() != constants::numRows)) {
+            return false;
+        }
+        parser::boardToState(worker.board, worker.state);
+        return true;
+    }
+
+    static void solveLine(Worker& worker, std::string_view line, std::string& output, Counters& counters)
+    {
+        ++counters.numBoards;
+        if (!parse(worker, line)) {
+            ++counters.numInvalid;
+            output += "invalid\n";
+            return;
+        }
+
+        worker.solver.load(worker.state);
+        solveLoaded(worker, worker.state, output, counters);
+    }
+
+    /** Solve the board loaded into the solver, through the cache if there
+     *  is one, `givens` being the board as parsed. */
+    static void solveLoaded(Worker& worker, const types::state_t& givens, std::string& output, Counters& counters)
+    {
+        auto cached = false;
+        auto solved = false;
+        if (worker.cache != nullptr) {
+            const auto status = worker.cache->solve(worker.solver, givens, Solver::Limits(), output, cached);
+            solved = (status == Solver::Status::Solved);
+        } else {
+            solved = worker.solver.trySolve();
+            if (solved) {
+                worker.solver.appendValues(output);
+            }
+        }
+
+        if (solved) {
+            output += '\n';
+            ++counters.numSolved;
+        } else {
+            ++counters.numUnsolvable;
+            output += "unsolvable\n";
+        }
+        if (!cached) {
+            counters.stats += worker.solver.stats();
+        }
+    }
+
+    /** Propagate up to LaneSolver::numLanes lines together, then search the
+     *  boards that propagation alone didn't solve one by one. */
+    static void solveLanes(Worker& worker, const std::string_view* lines, size_t numLines, std::string& output,
+        Counters& counters)
+    {
+        std::array<bool, LaneSolver::numLanes> valid;
+        worker.lanes.clear();
+        for (size_t lane = 0; lane < numLines; ++lane) {
+            valid[lane] = parse(worker, lines[lane]);
+            if (valid[lane]) {
+                worker.lanes.load(lane, worker.state);
+                if (worker.cache != nullptr) {
+                    worker.givens[lane] = worker.state;
+                }
+            }
+        }
+
+        worker.lanes.propagate();
+
+        char solution[constants::numElements];
+        for (size_t lane = 0; lane < numLines; ++lane) {
+            ++counters.numBoards;
+            if (!valid[lane]) {
+                ++counters.numInvalid;
+                output += "invalid\n";
+                continue;
+            }
+
+            switch (worker.lanes.status(lane)) {
+                case LaneSolver::Status::Solved:
+                    worker.lanes.storeSolution(lane, solution);
+                    output.append(solution, constants::numElements);
+                    output += '\n';
+                    ++counters.numSolved;
+                    break;
+                case LaneSolver::Status::Contradiction:
+                    ++counters.numUnsolvable;
+                    output += "unsolvable\n";
+                    break;
+                case LaneSolver::Status::NeedsSearch:
+                    worker.lanes.store(lane, worker.state);
+                    worker.solver.load(worker.state);
+                    solveLoaded(worker, worker.givens[lane], output, counters);
+                    break;
+            }
+        }
+    }
+
+    /** Solve every non-empty line of `text`. */
+    static void solveText(Worker& worker, std::string_view text, std::string& output, Counters& counters)
+    {
+        std::array<std::string_view, LaneSolver::numLanes> lines;
+        size_t numLines = 0;
+        while (!text.empty()) {
+            const auto line = input::nextLine(text);
+            if (line.empty()) {
+                continue;
+            }
+
+            if (!worker.useLanes) {
+                solveLine(worker, line, output, counters);
+                continue;
+            }
+
+            lines[numLines++] = line;
+            if (numLines == lines.size()) {
+                solveLanes(worker, lines.data(), numLines, output, counters);
+                numLines = 0;
+            }
+        }
+        if (numLines != 0) {
+            solveLanes(worker, lines.data(), numLines, output, counters);
+        }
+    }
+
+    /** Fill `chunk` with the next lines of the input, returns false at its end. */
+    static bool readChunk(Batch& self, Chunk& chunk)
+    {
+        if (self.inputStream == nullptr) {
+            chunk.text = input::takeLines(self.inputText, chunkBytes);
+            return !chunk.text.empty();
+        }
+
+        chunk.buffer.clear();
+        std::string line;
+        for (size_t i = 0; (i < chunkLines) && std::getline(*self.inputStream, line); ++i) {
+            chunk.buffer += line;
+            chunk.buffer += '\n';
+        }
+        chunk.text = chunk.buffer;
+        return !chunk.text.empty();
+    }
+
+    static Counters runSequential(Batch& self)
+    {
+        Counters counters;
+        Worker worker(self.options, self.cache.get());
+        Chunk chunk;
+        while (readChunk(self, chunk)) {
+            chunk.output.clear();
+            solveText(worker, chunk.text, chunk.output, counters);
+            self.output.write(chunk.output.data(), chunk.output.size());
+        }
+        return counters;
+    }
+
+    static Counters runParallel(Batch& self)
+    {
+        ThreadPool pool(self.options.numThreads);
+        std::vector<Worker> workers(pool.size(), Worker(self.options, self.cache.get()));
+
+        Counters counters;
+        OrderedChunks<Chunk> chunks(pool, chunksInFlightPerWorker * pool.size(),
+            [&](Chunk& chunk, size_t workerIndex) {
+                solveText(workers[workerIndex], chunk.text, chunk.output, chunk.counters);
+            },
+            [&](Chunk& chunk) {
+                self.output.write(chunk.output.data(), chunk.output.size());
+                counters += chunk.counters;
+            });
+
+        for (;;) {
+            auto chunk = chunks.next();
+            if (!readChunk(self, *chunk)) {
+                break;
+            }
+            chunk->output.clear();
+            chunk->counters = Counters();
+            chunks.submit(std::move(chunk));
+        }
+        chunks.finish();
+
+        return counters;
+    }
+};
+
+
+Batch::Batch(std::istream& input, std::ostream& output, const Options& options)
+    : inputStream(&input)
+    , output(output)
+    , options(options)
+{}
+
+Batch::Batch(std::string_view input, std::ostream& output, const Options& options)
+    : inputText(input)
+    , output(output)
+    , options(options)
+{}
+
+Batch::~Batch()
+{}
+
+int Batch::run()
+{
+    std::ios::sync_with_stdio(false);
+
+    if (options.cacheSize != 0) {
+        cache = std::make_unique<SolutionCache>(options.cacheSize);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    const auto counters = (options.numThreads == 1) ? Private::runSequential(*this) : Private::runParallel(*this);
+    output.flush();
+
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const auto throughput = (elapsed > 0.0) ? counters.numBoards / elapsed : 0.0;
+    std::cerr << "Boards: " << counters.numBoards << " (solved: " << counters.numSolved
+        << ", unsolvable: " << counters.numUnsolvable << ", invalid: " << counters.numInvalid << ") in "
+        << elapsed << " s, " << throughput << " boards/s";
+    if (options.useLanes) {
+        std::cerr << " (lanes: " << LaneSolver::implementation() << ')';
+    }
+    std::cerr << '\n';
+    if (cache) {
+        display::printCacheStats(cache->stats(), std::cerr);
+    }
+    if (options.printStats) {
+        display::printStats(counters.stats, std::cerr);
+    }
+
+    return (counters.numSolved == counters.numBoards) ? 0 : 2;
+}
+
+}  // namespace sudoku
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string_view>
+
+#include "interface.h"
+#include "solver.h"
+
+
+namespace sudoku
+{
+
+class SolutionCache;
+
+/** Solve many boards back to back in a single process.
+ *
+ *  Every non-empty line of the input is a 9x9 board in one of the formats of
+ *  parser::parseBoard(). For each of them a single line is written to
+ *  the output: the 81 values of the solution, "unsolvable" or "invalid".
+ *  The number of boards and the throughput are reported on stderr at the end.
+ *
+ *  The input is either a stream or a text already in memory, typically an
+ *  input::MappedFile. Boards of 81 characters are parsed straight from the
+ *  text into the state of the solver, see parser::parseLine(). A board with
+ *  a value repeated in a row, column or box is "invalid" without any
+ *  solving.
+ *
+ *  With more than one thread the input is solved in chunks of whole lines
+ *  on a ThreadPool, each worker with its own Solver, and the results are
+ *  written in the order of the input.
+ *
+ *  With a cache, boards equivalent to one solved before are answered from
+ *  a SolutionCache shared by all the workers, and its hit rate is reported
+ *  as well. */
+class Batch: public Interface
+{
+public:
+    struct Options
+    {
+        Solver::Engine engine = Solver::Engine::Propagation;
+        Solver::Techniques techniques;
+        /// zero means one per hardware thread
+        size_t numThreads = 1;
+        /// propagate 16 boards at once with a LaneSolver before any search
+        bool useLanes = false;
+        /// print the sum of Solver::stats() over all boards to stderr; with
+        /// useLanes only the boards that still need a search are counted
+        bool printStats = false;
+        /// the number of boards of the SolutionCache, none if zero
+        size_t cacheSize = 0;
+    };
+
+    Batch(std::istream& input, std::ostream& output, const Options& options);
+    Batch(std::string_view input, std::ostream& output, const Options& options);
+    ~Batch();
+
+    /** Returns 0 if every board got solved, 2 otherwise. */
+    int run() override;
+
+private:
+    std::istream* inputStream = nullptr;
+    std::string_view inputText;
+    std::ostream& output;
+    Options options;
+    std::unique_ptr<SolutionCache> cache;
+    struct Private;
+};
+
+}  // namespace sudoku
@@ -0,0 +1,305 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "canonical.h"
+
+
+namespace sudoku
+{
+
+namespace canonical
+{
+
+namespace
+{
+
+using constants::boxSize;
+using constants::numColumns;
+using constants::numElements;
+using constants::numRows;
+using constants::numValues;
+using grid = constants::Grid<constants::boxSize>;
+
+// the code of an unknown cell, after every label so that givens come first
+const std::uint8_t unknown = numValues;
+// partial transforms followed at most, beyond that a board is given up on
+const size_t maxCandidates = 4096;
+
+// the index of the value of every cell, `unknown` for the unknown ones
+using cells_t = std::array<std::array<std::uint8_t, numColumns>, numRows>;
+// the codes of a row of the canonical form: labels, or `unknown`
+using codes_t = std::array<std::uint8_t, numColumns>;
+
+const std::array<std::array<std::uint8_t, boxSize>, 6> permutations = {{
+    {0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0},
+}};
+
+/** A transform whose first rows give the smallest prefix found so far. */
+struct Candidate
+{
+    /// the source row of each row of the canonical form chosen so far
+    std::array<std::uint8_t, numRows> rows;
+    /// the source column of each column of the canonical form
+    std::array<std::uint8_t, numColumns> columns;
+    /// the label of each value, `unknown` for the values not seen yet
+    std::array<std::uint8_t, numValues> labels;
+    std::uint8_t numLabels;
+    bool transposed;
+    std::uint16_t usedRows;
+};
+
+/** The codes of row `source` in the column order of `candidate`, labelling
+ *  the values it sees for the first time. */
+void encodeRow(const cells_t& cells, Candidate& candidate, size_t source, codes_t& codes)
+{
+    for (size_t j = 0; j < numColumns; ++j) {
+        const auto value = cells[source][candidate.columns[j]];
+        if (value == unknown) {
+            codes[j] = unknown;
+            continue;
+        }
+        if (candidate.labels[value] == unknown) {
+            candidate.labels[value] = candidate.numLabels++;
+        }
+        codes[j] = candidate.labels[value];
+    }
+}
+
+/** Like encodeRow(), but stop as soon as the codes turn out greater than
+ *  `bound`. Returns a negative number, zero or a positive number if the
+ *  codes are less than, equal to or greater than `bound`. */
+int encodeRow(const cells_t& cells, Candidate& candidate, size_t source, const codes_t& bound, codes_t& codes)
+{
+    auto order = 0;
+    for (size_t j = 0; j < numColumns; ++j) {
+        const auto value = cells[source][candidate.columns[j]];
+        auto code = unknown;
+        if (value != unknown) {
+            if (candidate.labels[value] == unknown) {
+                candidate.labels[value] = candidate.numLabels++;
+            }
+            code = candidate.labels[value];
+        }
+        codes[j] = code;
+        if (order == 0) {
+            if (code > bound[j]) {
+                return 1;
+            }
+            order = (code < bound[j]) ? -1 : 0;
+        }
+    }
+    return order;
+}
+
+/** The number of givens of row `source` in each stack. */
+std::array<size_t, boxSize> countGivens(const cells_t& cells, size_t source)
+{
+    std::array<size_t, boxSize> counts{};
+    for (size_t j = 0; j < numColumns; ++j) {
+        counts[j / boxSize] += (cells[source][j] != unknown);
+    }
+    return counts;
+}
+
+/** Every column order that puts the givens of row `source` as far left as
+ *  possible: stacks with more givens first, givens first within a stack.
+ *  All of them give the first row the same codes. */
+void addFirstRows(const cells_t& cells, size_t source, bool transposed, std::vector<Candidate>& candidates)
+{
+    const auto counts = countGivens(cells, source);
+
+    // the orders of the columns of each stack with its givens first
+    std::array<std::array<size_t, permutations.size()>, boxSize> orders;
+    std::array<size_t, boxSize> numOrders{};
+    for (size_t stack = 0; stack < boxSize; ++stack) {
+        for (size_t order = 0; order < permutations.size(); ++order) {
+            auto givensFirst = true;
+            for (size_t k = 0; k < boxSize; ++k) {
+                const auto column = stack * boxSize + permutations[order][k];
+                givensFirst = givensFirst && ((k < counts[stack]) == (cells[source][column] != unknown));
+            }
+            if (givensFirst) {
+                orders[stack][numOrders[stack]++] = order;
+            }
+        }
+    }
+
+    Candidate candidate;
+    candidate.rows.fill(0);
+    candidate.rows[0] = static_cast<std::uint8_t>(source);
+    candidate.transposed = transposed;
+    candidate.usedRows = static_cast<std::uint16_t>(1u << source);
+    for (const auto& stacks: permutations) {
+        if ((counts[stacks[0]] < counts[stacks[1]]) || (counts[stacks[1]] < counts[stacks[2]])) {
+            continue;
+        }
+        for (size_t first = 0; first < numOrders[stacks[0]]; ++first) {
+            for (size_t second = 0; second < numOrders[stacks[1]]; ++second) {
+                for (size_t third = 0; third < numOrders[stacks[2]]; ++third) {
+                    const std::array<size_t, boxSize> chosen = {
+                        orders[stacks[0]][first], orders[stacks[1]][second], orders[stacks[2]][third]};
+                    for (size_t stack = 0; stack < boxSize; ++stack) {
+                        for (size_t k = 0; k < boxSize; ++k) {
+                            candidate.columns[stack * boxSize + k] =
+                                static_cast<std::uint8_t>(stacks[stack] * boxSize + permutations[chosen[stack]][k]);
+                        }
+                    }
+                    candidate.labels.fill(unknown);
+                    candidate.numLabels = 0;
+                    codes_t codes;
+                    encodeRow(cells, candidate, source, codes);
+                    candidates.push_back(candidate);
+                }
+            }
+        }
+    }
+}
+
+/** The codes of the first row of the canonical form for row `source`. */
+codes_t firstRowCodes(const cells_t& cells, size_t source)
+{
+    auto counts = countGivens(cells, source);
+    std::sort(counts.begin(), counts.end(), std::greater<size_t>());
+    codes_t codes;
+    std::uint8_t label = 0;
+    for (size_t stack = 0; stack < boxSize; ++stack) {
+        for (size_t k = 0; k < boxSize; ++k) {
+            codes[stack * boxSize + k] = (k < counts[stack]) ? label++ : unknown;
+        }
+    }
+    return codes;
+}
+
+char symbolOf(std::uint8_t code)
+{
+    return (code == unknown) ? '.' : grid::symbol(code);
+}
+
+}  // namespace
+
+
+void Transform::toCanonical(const values_t& original, values_t& canonical) const
+{
+    for (size_t i = 0; i < numElements; ++i) {
+        const auto value = original[sourceCell[i]];
+        canonical[i] = (value == '.') ? '.' : grid::symbol(labelOf[grid::indexOf(value)]);
+    }
+}
+
+void Transform::fromCanonical(const values_t& canonical, values_t& original) const
+{
+    for (size_t i = 0; i < numElements; ++i) {
+        const auto label = canonical[i];
+        original[sourceCell[i]] = (label == '.') ? '.' : grid::symbol(valueOf[grid::indexOf(label)]);
+    }
+}
+
+bool canonicalize(const types::state_t& state, values_t& key, Transform& transform)
+{
+    // the board and its transposition
+    std::array<cells_t, 2> cells;
+    for (size_t i = 0; i < numRows; ++i) {
+        for (size_t j = 0; j < numColumns; ++j) {
+            const auto& cell = state.cells[i][j];
+            const auto value = (cell.size() == 1) ? static_cast<std::uint8_t>(grid::indexOf(cell.single())) : unknown;
+            cells[0][i][j] = value;
+            cells[1][j][i] = value;
+        }
+    }
+
+    thread_local std::vector<Candidate> candidates;
+    thread_local std::vector<Candidate> nextCandidates;
+    candidates.clear();
+
+    // the first row: the row with the most givens packed to the left
+    codes_t best;
+    best.fill(unknown + 1);
+    for (size_t transposed = 0; transposed < 2; ++transposed) {
+        for (size_t source = 0; source < numRows; ++source) {
+            best = std::min(best, firstRowCodes(cells[transposed], source));
+        }
+    }
+    for (size_t transposed = 0; transposed < 2; ++transposed) {
+        for (size_t source = 0; source < numRows; ++source) {
+            if (firstRowCodes(cells[transposed], source) == best) {
+                addFirstRows(cells[transposed], source, transposed != 0, candidates);
+                if (candidates.size() > maxCandidates) {
+                    return false;
+                }
+            }
+        }
+    }
+    std::transform(best.begin(), best.end(), key.begin(), symbolOf);
+
+    // every other row: the smallest codes any candidate can give it
+    for (size_t row = 1; row < numRows; ++row) {
+        nextCandidates.clear();
+        best.fill(unknown + 1);
+        for (const auto& candidate: candidates) {
+            const auto& board = cells[candidate.transposed];
+            // a row of the same band, or the first row of a band not used yet
+            const auto band = candidate.rows[row - 1] / boxSize;
+            for (size_t source = 0; source < numRows; ++source) {
+                if ((candidate.usedRows & (1u << source)) != 0) {
+                    continue;
+                }
+                if ((row % boxSize) != 0) {
+                    if (source / boxSize != band) {
+                        continue;
+                    }
+                } else if ((candidate.usedRows & (0b111u << (source / boxSize * boxSize))) != 0) {
+                    continue;
+                }
+
+                auto next = candidate;
+                codes_t codes;
+                const auto order = encodeRow(board, next, source, best, codes);
+                if (order > 0) {
+                    continue;
+                }
+                if (order < 0) {
+                    best = codes;
+                    nextCandidates.clear();
+                }
+                next.rows[row] = static_cast<std::uint8_t>(source);
+                next.usedRows |= static_cast<std::uint16_t>(1u << source);
+                nextCandidates.push_back(next);
+                if (nextCandidates.size() > maxCandidates) {
+                    return false;
+                }
+            }
+        }
+        candidates.swap(nextCandidates);
+        std::transform(best.begin(), best.end(), key.begin() + row * numColumns, symbolOf);
+    }
+
+    // any of the remaining candidates gives the canonical form
+    const auto& candidate = candidates.front();
+    for (size_t i = 0; i < numRows; ++i) {
+        for (size_t j = 0; j < numColumns; ++j) {
+            const auto row = candidate.rows[i];
+            const auto column = candidate.columns[j];
+            transform.sourceCell[i * numColumns + j] =
+                static_cast<std::uint8_t>(candidate.transposed ? column * numColumns + row : row * numColumns + column);
+        }
+    }
+    // the values that are not given get the remaining labels in order
+    auto labels = candidate.labels;
+    auto numLabels = candidate.numLabels;
+    for (auto& label: labels) {
+        if (label == unknown) {
+            label = numLabels++;
+        }
+    }
+    for (size_t value = 0; value < numValues; ++value) {
+        transform.labelOf[value] = labels[value];
+        transform.valueOf[labels[value]] = static_cast<std::uint8_t>(value);
+    }
+    return true;
+}
+
+}  // namespace canonical
+
+}  // namespace sudoku
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "constants.h"
+#include "types.h"
+
+
+namespace sudoku
+{
+
+/** The canonical form of a 9x9 board under the symmetries of sudoku.
+ *
+ *  Relabelling the digits, permuting the rows within a band, the bands,
+ *  the columns within a stack and the stacks, and transposing all turn a
+ *  board into an equivalent one: its solutions are the transformed
+ *  solutions of the original. Every board of such a class of equivalent
+ *  boards gets the same canonical form, which makes it a key for caching
+ *  solutions, see SolutionCache. */
+namespace canonical
+{
+
+/** The values of all the cells, row by row, '.' for an unknown cell: the
+ *  format of display::appendValues(). */
+using values_t = std::array<char, constants::numElements>;
+
+/** A symmetry mapping a board to its canonical form. */
+struct Transform
+{
+    /// the cell of the original board each cell of the canonical form comes from
+    std::array<std::uint8_t, constants::numElements> sourceCell;
+    /// the index of the canonical value of each original value, and the other way round
+    std::array<std::uint8_t, constants::numValues> labelOf;
+    std::array<std::uint8_t, constants::numValues> valueOf;
+
+    /** Map the values of the original board, e.g. its solution, to the canonical form. */
+    void toCanonical(const values_t& original, values_t& canonical) const;
+
+    /** Map the values of the canonical form, e.g. its solution, back to the original board. */
+    void fromCanonical(const values_t& canonical, values_t& original) const;
+};
+
+/** Compute the canonical form of the fixed cells of `state` into `key` and
+ *  the transform that leads to it.
+ *
+ *  The canonical form is the lexicographically smallest of all the
+ *  equivalent boards, rows first, givens before unknown cells, with the
+ *  digits numbered in the order of their first appearance. It is built
+ *  row by row, keeping only the partial transforms that give the smallest
+ *  prefix, so most boards take a few thousand cell comparisons. Boards
+ *  with so much symmetry that too many transforms tie (like an empty
+ *  board) are given up on, and false is returned; whether that happens is
+ *  the same for every board of a class. */
+bool canonicalize(const types::state_t& state, values_t& key, Transform& transform);
+
+}  // namespace canonical
+
+}  // namespace sudoku
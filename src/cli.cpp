@@ -1,8 +1,21 @@
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
 #include <cstring>
+#include <fstream>
 #include <iostream>
+#include <system_error>
 
+#include "batch.h"
 #include "cli.h"
 #include "constants.h"
+#include "display.h"
+#include "generator.h"
+#include "input.h"
+#include "parser.h"
+#include "server.h"
+#include "trace.h"
 
 
 namespace sudoku
@@ -12,7 +25,12 @@ CommandLine::CommandLine(int argc, char* argv[])
 {
     arguments.reserve(argc);
     for (auto i = 0; i < argc; ++i) {
-        arguments.emplace_back(argv[i]);
+        const auto argument = std::string(argv[i]);
+        if ((i > 0) && argument.starts_with("--")) {
+            options.push_back(argument);
+        } else {
+            arguments.push_back(argument);
+        }
     }
 }
 
@@ -23,44 +41,7 @@ Solver::board_t CommandLine::parseBoard(const Solver::arguments_t& args)
 {
     Solver::board_t board;
     if (args.size() > 1) {
-        const auto& input = args[1];
-
-        int rowIndex = -1;
-        enum State { StartNewRow, ExtractColumns, Abort };
-        auto state = State::StartNewRow;
-        for (auto ch: input) {
-            switch (state) {
-                case State::StartNewRow:
-                    if (ch == '[') {
-                        ++rowIndex;
-                        board.emplace_back();
-                        state = State::ExtractColumns;
-                    }
-                    break;
-                case State::ExtractColumns:
-                    if (ch == ']') {
-                        if (board[rowIndex].size() != constants::numColumns) {
-                            std::cerr << "Expected " << constants::numColumns << " columns in row " << (rowIndex + 1)
-                                << ", got " << board[rowIndex].size() << '\n';
-                            board.clear();
-                            state = State::Abort;
-                        } else {
-                            state = State::StartNewRow;
-                        }
-                    } else if ((ch != '[') && (ch != ',') && (ch != '"') && (ch != '\'')) {
-                        board[rowIndex].emplace_back(ch);
-                    }
-                    break;
-                case State::Abort:
-                    goto endloop;
-            }
-        }
-endloop:
-
-        if (!board.empty() && (board.size() != constants::numRows)) {
-            std::cerr << "Expected " << constants::numRows << " rows, got " << board.size() << '\n';
-            board.clear();
-        }
+        parseBoard(args[1], board);
     } else {
         const auto num_args = args.size() - 1;
         std::cerr << "Expected at least one argument, got " << num_args << '\n';
@@ -68,10 +49,237 @@ endloop:
     return board;
 }
 
-int CommandLine::run()
+bool CommandLine::parseBoard(std::string_view input, Solver::board_t& board)
 {
-    auto board = CommandLine::parseBoard(arguments);
-    Solver solver(board);
+    parser::Error error;
+    if (!parser::parseBoard(input, board, error)) {
+        std::cerr << error.message << " (at character " << (error.position + 1) << ")\n";
+        board.clear();
+        return false;
+    }
+    return true;
+}
+
+// the boards of --cache without a size, about 20 MB
+static const size_t defaultCacheSize = 100000;
+
+template<typename Number>
+static bool parseCount(const std::string& text, Number& count)
+{
+    const auto end = text.data() + text.size();
+    const auto [ptr, error] = std::from_chars(text.data(), end, count);
+    return (error == std::errc()) && (ptr == end);
+}
+
+static bool parseTechniques(std::string_view list, Solver::Techniques& techniques)
+{
+    techniques = Solver::Techniques();
+    while (!list.empty()) {
+        const auto end = std::min(list.find(','), list.size());
+        const auto name = list.substr(0, end);
+        list.remove_prefix(std::min(end + 1, list.size()));
+
+        if (name == "all") {
+            techniques = Solver::Techniques::all();
+        } else if (name == "none") {
+            techniques = Solver::Techniques();
+        } else if (name == "intersections") {
+            techniques.intersections = true;
+        } else if (name == "naked-pairs") {
+            techniques.nakedPairs = true;
+        } else if (name == "hidden-pairs") {
+            techniques.hiddenPairs = true;
+        } else if (name == "naked-triples") {
+            techniques.nakedTriples = true;
+        } else if (name == "hidden-triples") {
+            techniques.hiddenTriples = true;
+        } else if (name == "x-wing") {
+            techniques.xWing = true;
+        } else {
+            std::cerr << "Unknown technique " << name << '\n';
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CommandLine::parseOptions()
+{
+    for (const auto& option: options) {
+        if (option == "--engine=propagation") {
+            engine = Solver::Engine::Propagation;
+        } else if (option == "--engine=dlx") {
+            engine = Solver::Engine::DancingLinks;
+        } else if (option.starts_with("--techniques=")) {
+            if (!parseTechniques(std::string_view(option).substr(option.find('=') + 1), techniques)) {
+                return false;
+            }
+        } else if (option == "--batch") {
+            batchInput.emplace("-");
+        } else if (option.starts_with("--batch=")) {
+            batchInput = option.substr(option.find('=') + 1);
+        } else if (option == "--simd") {
+            useLanes = true;
+        } else if (option == "--stats") {
+            printStats = true;
+        } else if (option == "--count") {
+            solutionLimit = 2;
+        } else if (option.starts_with("--count=")) {
+            if (!parseCount(option.substr(option.find('=') + 1), solutionLimit.emplace())) {
+                std::cerr << "Expected a number of solutions in " << option << '\n';
+                return false;
+            }
+        } else if (option == "--serve") {
+            serveSocket.emplace();
+        } else if (option.starts_with("--serve=")) {
+            serveSocket = option.substr(option.find('=') + 1);
+            if (serveSocket->empty()) {
+                std::cerr << "Expected the path of a socket in " << option << '\n';
+                return false;
+            }
+        } else if (option == "--cache") {
+            cacheSize = defaultCacheSize;
+        } else if (option.starts_with("--cache=")) {
+            if (!parseCount(option.substr(option.find('=') + 1), cacheSize) || (cacheSize == 0)) {
+                std::cerr << "Expected a positive number of boards in " << option << '\n';
+                return false;
+            }
+        } else if (option.starts_with("--timeout=")) {
+            if (!parseCount(option.substr(option.find('=') + 1), timeoutMilliseconds) || (timeoutMilliseconds == 0)) {
+                std::cerr << "Expected a positive number of milliseconds in " << option << '\n';
+                return false;
+            }
+        } else if (option.starts_with("--max-branches=")) {
+            if (!parseCount(option.substr(option.find('=') + 1), maxBranches) || (maxBranches == 0)) {
+                std::cerr << "Expected a positive number of branches in " << option << '\n';
+                return false;
+            }
+        } else if (option.starts_with("--generate=")) {
+            if (!parseCount(option.substr(option.find('=') + 1), numPuzzles.emplace())) {
+                std::cerr << "Expected a number of puzzles in " << option << '\n';
+                return false;
+            }
+        } else if (option.starts_with("--clues=")) {
+            if (!parseCount(option.substr(option.find('=') + 1), numClues) || (numClues > constants::numElements)) {
+                std::cerr << "Expected a number of clues up to " << constants::numElements << " in " << option << '\n';
+                return false;
+            }
+        } else if (option.starts_with("--seed=")) {
+            if (!parseCount(option.substr(option.find('=') + 1), seed)) {
+                std::cerr << "Expected a number in " << option << '\n';
+                return false;
+            }
+        } else if (option.starts_with("--trace=")) {
+            traceOutput = option.substr(option.find('=') + 1);
+            if (traceOutput->empty()) {
+                std::cerr << "Expected the path of a file in " << option << '\n';
+                return false;
+            }
+        } else if (option.starts_with("--trace-json=")) {
+            traceInput = option.substr(option.find('=') + 1);
+            if (traceInput->empty()) {
+                std::cerr << "Expected the path of a file in " << option << '\n';
+                return false;
+            }
+        } else if (option == "--threads") {
+            numThreads = 0;
+        } else if (option.starts_with("--threads=")) {
+            if (!parseCount(option.substr(option.find('=') + 1), numThreads) || (numThreads == 0)) {
+                std::cerr << "Expected a positive number of threads in " << option << '\n';
+                return false;
+            }
+        } else {
+            std::cerr << "Unknown option " << option << '\n';
+            return false;
+        }
+    }
+    if (solutionLimit && batchInput) {
+        std::cerr << "--count can't be combined with --batch\n";
+        return false;
+    }
+    if (((timeoutMilliseconds != 0) || (maxBranches != 0)) && (batchInput || solutionLimit || numPuzzles)) {
+        std::cerr << "--timeout and --max-branches only apply to a single board and --serve\n";
+        return false;
+    }
+    if (traceOutput && (batchInput || serveSocket || solutionLimit || numPuzzles || (numThreads != 1))) {
+        std::cerr << "--trace only applies to a single board solved on one thread\n";
+        return false;
+    }
+    if ((cacheSize != 0) && !batchInput && !serveSocket) {
+        std::cerr << "--cache needs --batch or --serve\n";
+        return false;
+    }
+    return true;
+}
+
+int CommandLine::runBatch() const
+{
+    const Batch::Options options{engine, techniques, numThreads, useLanes, printStats, cacheSize};
+    if (*batchInput == "-") {
+        return Batch(std::cin, std::cout, options).run();
+    }
+    if (!input::isRegularFile(*batchInput)) {
+        // pipes and FIFOs can't be mapped, they are read like stdin
+        std::ifstream input(*batchInput);
+        if (!input) {
+            std::cerr << "Can't open " << *batchInput << ": " << std::strerror(errno) << '\n';
+            return 1;
+        }
+        return Batch(input, std::cout, options).run();
+    }
+
+    try {
+        const input::MappedFile file(*batchInput);
+        return Batch(file.contents(), std::cout, options).run();
+    } catch (const std::system_error& error) {
+        std::cerr << "Can't open " << *batchInput << ": " << error.code().message() << '\n';
+        return 1;
+    }
+}
+
+int CommandLine::runServer() const
+{
+    const Server::Options options{engine, techniques, numThreads, *serveSocket,
+        std::chrono::milliseconds(timeoutMilliseconds), maxBranches, cacheSize};
+    try {
+        return Server(options).run();
+    } catch (const std::system_error& error) {
+        std::cerr << error.what() << ": " << error.code().message() << '\n';
+        return 1;
+    }
+}
+
+int CommandLine::dumpTrace() const
+{
+    std::ifstream input(*traceInput, std::ios::binary);
+    if (!input) {
+        std::cerr << "Can't open " << *traceInput << '\n';
+        return 1;
+    }
+    trace::Trace trace;
+    if (!trace::read(input, trace)) {
+        std::cerr << *traceInput << " is not a trace of --trace, or it is truncated\n";
+        return 1;
+    }
+    trace::writeChromeJson(trace, std::cout);
+    return 0;
+}
+
+Solver::Limits CommandLine::limits() const
+{
+    Solver::Limits limits;
+    if (timeoutMilliseconds != 0) {
+        limits.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMilliseconds);
+    }
+    limits.maxBranches = maxBranches;
+    return limits;
+}
+
+template<size_t BoxSize, typename TraceSink>
+int CommandLine::solveBoard(Solver::board_t& board) const
+{
+    BasicSolver<BoxSize, TraceSink> solver(board, engine);
+    solver.setTechniques(techniques);
 
     std::cout << "Input:\n";
     auto useSimpleFormat = true;
@@ -79,25 +287,128 @@ int CommandLine::run()
     std::cout << "Unknown elements: " << solver.unknownCount() <<
         " (" << solver.unknownPercent() << "%)\n";
 
-    int exitCode;
-    if (board.empty()) {
-        exitCode = 1;
-    } else {
-        sudoku::Solver solver(board);
-        try {
-            std::cout << "Working on a solution...\n";
-            solver.solve();
+    int exitCode = 0;
+    try {
+        std::cout << "Working on a solution...\n";
+        const auto limits = this->limits();
+        if (!limits.any()) {
+            solver.solveParallel(numThreads);
             std::cout << "Solution:\n";
             exitCode = 0;
-        } catch(const sudoku::Solver::IAmStuck& ex) {
-            std::cout << "The solver stopped with this error: " << ex.what() << '\n';
-            exitCode = 2;
+        } else {
+            const auto status = solver.solve(limits);
+            switch (status) {
+                case Solver::Status::Solved:
+                    std::cout << "Solution:\n";
+                    exitCode = 0;
+                    break;
+                case Solver::Status::NoSolution:
+                    std::cout << "There is no solution for this board\n";
+                    exitCode = 2;
+                    break;
+                case Solver::Status::TimedOut:
+                case Solver::Status::OutOfBudget:
+                    std::cout << "The solver gave up "
+                        << ((status == Solver::Status::TimedOut) ? "at the deadline" : "after its budget of branches")
+                        << ", the board so far (unknown elements: " << solver.unknownCount() << "):\n";
+                    exitCode = 3;
+                    break;
+            }
+        }
+    } catch(const sudoku::Solver::NoSolution& ex) {
+        std::cout << "The solver stopped with this error: " << ex.what() << '\n';
+        exitCode = 2;
+    }
+    useSimpleFormat = (arguments.size() >= 3) && (arguments[2] == "simple");
+    solver.printState(useSimpleFormat);
+    if (printStats) {
+        display::printStats(solver.stats(), std::cout);
+    }
+
+    if constexpr (TraceSink::enabled) {
+        std::ofstream output(*traceOutput, std::ios::binary);
+        solver.traceSink().write(output, constants::Grid<BoxSize>::numColumns);
+        if (!output.flush()) {
+            std::cerr << "Can't write the trace to " << *traceOutput << '\n';
+            return 1;
         }
-        useSimpleFormat = (arguments.size() >= 3) && (arguments[2] == "simple");
-        solver.printState(useSimpleFormat);
     }
 
     return exitCode;
 }
 
+template<size_t BoxSize>
+int CommandLine::countSolutions(Solver::board_t& board) const
+{
+    BasicSolver<BoxSize> solver(board, engine);
+    solver.setTechniques(techniques);
+
+    const auto limit = *solutionLimit;
+    const auto count = solver.countSolutions(limit);
+    std::cout << "Solutions: ";
+    if ((limit != 0) && (count >= limit)) {
+        std::cout << "at least ";
+    }
+    std::cout << count << '\n';
+    if (count != 0) {
+        const auto useSimpleFormat = (arguments.size() >= 3) && (arguments[2] == "simple");
+        std::cout << (count == 1 ? "Solution:\n" : "First solution:\n");
+        solver.printState(useSimpleFormat);
+    }
+    if (printStats) {
+        display::printStats(solver.stats(), std::cout);
+    }
+
+    return (count == 0) ? 2 : 0;
+}
+
+template<size_t BoxSize>
+int CommandLine::solveOrCount(Solver::board_t& board) const
+{
+    if (solutionLimit) {
+        return countSolutions<BoxSize>(board);
+    }
+    return traceOutput ? solveBoard<BoxSize, trace::RingBuffer>(board) : solveBoard<BoxSize>(board);
+}
+
+int CommandLine::run()
+{
+    if (!parseOptions()) {
+        return 1;
+    }
+
+    if (batchInput) {
+        return runBatch();
+    }
+
+    if (serveSocket) {
+        return runServer();
+    }
+
+    if (traceInput) {
+        return dumpTrace();
+    }
+
+    if (numPuzzles) {
+        const Generator::Options options{*numPuzzles, numClues, seed, numThreads};
+        return Generator(std::cout, options).run();
+    }
+
+    auto board = CommandLine::parseBoard(arguments);
+    if (board.empty()) {
+        return 1;
+    }
+
+    switch (board.size()) {
+        case 4:
+            return solveOrCount<2>(board);
+        case 16:
+            return solveOrCount<4>(board);
+        case 25:
+            return solveOrCount<5>(board);
+        default:
+            return solveOrCount<3>(board);
+    }
+}
+
 }  // namespace sudoku
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
 #include "interface.h"
 #include "solver.h"
 
@@ -10,7 +15,66 @@ namespace sudoku
 class CommandLine: public Interface
 {
     Solver::arguments_t arguments;
+    Solver::arguments_t options;
+    Solver::Engine engine = Solver::Engine::Propagation;
+    Solver::Techniques techniques;
+    std::optional<std::string> batchInput;
+    size_t numThreads = 1;
+    bool useLanes = false;
+    bool printStats = false;
+    std::optional<size_t> solutionLimit;
+    std::optional<std::string> serveSocket;
+    size_t cacheSize = 0;
+    std::uint64_t timeoutMilliseconds = 0;
+    std::uint64_t maxBranches = 0;
+    std::optional<size_t> numPuzzles;
+    size_t numClues = 0;
+    std::uint64_t seed = 0;
+    std::optional<std::string> traceOutput;
+    std::optional<std::string> traceInput;
+
+    bool parseOptions();
+    int runBatch() const;
+    int runServer() const;
+    int dumpTrace() const;
+    Solver::Limits limits() const;
+    template<size_t BoxSize, typename TraceSink = trace::NullSink>
+    int solveBoard(Solver::board_t& board) const;
+    template<size_t BoxSize>
+    int countSolutions(Solver::board_t& board) const;
+    template<size_t BoxSize>
+    int solveOrCount(Solver::board_t& board) const;
 public:
+    /** Arguments starting with "--" are options, the rest are positional:
+     *
+     *  --engine=propagation|dlx  the algorithm of the solver
+     *  --techniques=LIST         deductions of the propagation engine besides singles, a
+     *                            comma-separated list of intersections, naked-pairs,
+     *                            hidden-pairs, naked-triples, hidden-triples, x-wing,
+     *                            all or none, see Solver::Techniques
+     *  --batch[=FILE]            solve every line of FILE (or stdin), see Batch
+     *  --simd                    propagate 16 boards at once in batch mode, see LaneSolver
+     *  --stats                   print the counters of Solver::stats(), summed up in batch mode
+     *  --count[=LIMIT]           print the number of solutions instead, counting no further
+     *                            than LIMIT (2 by default, 0 for all), see Solver::countSolutions()
+     *  --threads[=N]             use N threads (or one per hardware thread),
+     *                            for a single board see Solver::solveParallel()
+     *  --serve[=SOCKET]          answer requests of JSON lines on stdin (or on connections to
+     *                            the Unix domain socket SOCKET) until stopped, see Server
+     *  --cache[=N]               answer boards equivalent to one solved before from a cache
+     *                            of N boards (100000 by default) in batch and serve mode,
+     *                            see SolutionCache
+     *  --timeout=MS              give up on a board after MS milliseconds, printing how far
+     *                            it got, for a single board and --serve; see
+     *                            Solver::solve(const Limits&)
+     *  --max-branches=N          give up on a board after N branches of the search, the same way
+     *  --generate=N              write N puzzles with a unique solution, see Generator
+     *  --clues=N                 generate puzzles with N clues rather than minimal ones
+     *  --seed=N                  the seed of the generated puzzles, 0 by default
+     *  --trace=FILE              record the steps of solving a single board on one thread
+     *                            into FILE, see trace::RingBuffer
+     *  --trace-json=FILE         write the trace in FILE as Chrome trace JSON, see
+     *                            trace::writeChromeJson() */
     CommandLine(int argc, char* argv[]);
     ~CommandLine();
 
@@ -19,10 +83,23 @@ public:
      *  The program expects a single parameter in this format:
      *  '[[".",".","9","7","4","8",".",".","."],[...],...,[...]]'
      *
+     *  Grids of 4x4, 16x16 and 25x25 cells are accepted as well, their values
+     *  written as constants::symbols: 1-9 and then A-P.
+     *
      *  If an error is encountered an error message is printed to stderr
      *  and the returned board is empty. */
     static Solver::board_t parseBoard(const Solver::arguments_t& args);
 
+    /** Parse a sudoku board from a single string into `board`.
+     *
+     *  Any of the formats of parser::parseBoard() is accepted, e.g. the
+     *  81 characters of a 9x9 grid in a row. The capacity of `board` is
+     *  reused, so parsing many boards into the same one doesn't allocate.
+     *
+     *  Returns false if the input is malformed, the reason and its position
+     *  are printed to stderr. */
+    static bool parseBoard(std::string_view input, Solver::board_t& board);
+
     int run() override;
 };
 
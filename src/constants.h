@@ -1,15 +1,70 @@
+#pragma once
+
+#include <cstddef>
+
 namespace sudoku
 {
 
 namespace constants
 {
 
-const char maxValue = '9';
-const size_t boxSize = 3;
-const size_t numBoxes = 9;
-const size_t numRows = 9;
-const size_t numColumns = 9;
-const size_t numElements = numRows * numColumns;
+/** The symbols of the values of a cell in ascending order, digits first and
+ *  then letters, enough for a 25x25 grid. */
+constexpr char symbols[] = "123456789ABCDEFGHIJKLMNOP";
+
+const size_t minBoxSize = 2;
+const size_t maxBoxSize = 5;
+
+/** The dimensions of a grid made of `BoxSize` x `BoxSize` boxes of
+ *  `BoxSize` x `BoxSize` cells each. */
+template<size_t BoxSize>
+struct Grid
+{
+    static_assert((BoxSize >= minBoxSize) && (BoxSize <= maxBoxSize));
+
+    static const size_t boxSize = BoxSize;
+    static const size_t numValues = boxSize * boxSize;
+    static const size_t numBoxes = numValues;
+    static const size_t numRows = numValues;
+    static const size_t numColumns = numValues;
+    static const size_t numElements = numRows * numColumns;
+    static const char maxValue = symbols[numValues - 1];
+
+    /** The symbol of value number `index` (0 based). */
+    static constexpr char symbol(size_t index)
+    {
+        if constexpr (numValues <= 9) {
+            return static_cast<char>('1' + index);
+        } else {
+            return (index < 9) ? static_cast<char>('1' + index) : static_cast<char>('A' + (index - 9));
+        }
+    }
+
+    /** The number (0 based) of the value with `symbol`, see isSymbol(). */
+    static constexpr size_t indexOf(char symbol)
+    {
+        if constexpr (numValues <= 9) {
+            return static_cast<size_t>(symbol - '1');
+        } else {
+            return (symbol <= '9') ? static_cast<size_t>(symbol - '1') : static_cast<size_t>(symbol - 'A') + 9;
+        }
+    }
+
+    /** Whether `ch` is the symbol of a value of this grid. */
+    static constexpr bool isSymbol(char ch)
+    {
+        return ((ch >= '1') && (ch <= '9') && (ch <= maxValue)) || ((ch >= 'A') && (ch <= maxValue));
+    }
+};
+
+// the classic 9x9 grid
+const char maxValue = Grid<3>::maxValue;
+const size_t numValues = Grid<3>::numValues;
+const size_t boxSize = Grid<3>::boxSize;
+const size_t numBoxes = Grid<3>::numBoxes;
+const size_t numRows = Grid<3>::numRows;
+const size_t numColumns = Grid<3>::numColumns;
+const size_t numElements = Grid<3>::numElements;
 
 }  // namespace constants
 
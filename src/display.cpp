@@ -1,8 +1,7 @@
-#include <iomanip>
+#include <algorithm>
+#include <array>
 #include <iostream>
-#include <sstream>
 #include <string>
-#include <vector>
 
 #include "constants.h"
 #include "display.h"
@@ -15,127 +14,163 @@ namespace sudoku
 namespace display
 {
 
-struct BoxStrings
+/** Append `count` times `character`, a single glyph of UTF-8. */
+static void appendRepeated(std::string& output, size_t count, const char* character)
 {
-    std::vector<std::string> lines;
-    size_t longest = 0;
-};
-
-static void printHorizontalLine(size_t frame_width, const char* character = "═")
-{
-    for (auto i = 0; i < frame_width; ++i) {
-        std::cout << character;
+    for (size_t i = 0; i < count; ++i) {
+        output += character;
     }
 }
 
-static void printHeader(size_t frame_width)
-{
-    std::cout << "╔";
-    printHorizontalLine(frame_width);
-    std::cout << "╤";
-    printHorizontalLine(frame_width);
-    std::cout << "╤";
-    printHorizontalLine(frame_width);
-    std::cout << "╗\n";
-}
-
-static void printFooter(size_t frame_width)
+/** A horizontal line across `numBoxes` boxes, `left`, `middle` and `right`
+ *  being the characters at the frame and between the boxes. */
+static void appendBoxLine(std::string& output, size_t frameWidth, size_t numBoxes, const char* left,
+    const char* middle, const char* right, const char* character = "═")
 {
-    std::cout << "╚";
-    printHorizontalLine(frame_width);
-    std::cout << "╧";
-    printHorizontalLine(frame_width);
-    std::cout << "╧";
-    printHorizontalLine(frame_width);
-    std::cout << "╝\n";
+    output += left;
+    for (size_t box = 0; box < numBoxes; ++box) {
+        if (box != 0) {
+            output += middle;
+        }
+        appendRepeated(output, frameWidth, character);
+    }
+    output += right;
+    output += '\n';
 }
 
-static void printMiddleHorizontalLine(size_t frame_width)
+/** The text of a cell: its value, '.' in the simple format if it is
+ *  unknown, or else all of its potential values like "@1,5,9@". */
+template<size_t BoxSize>
+static void appendCell(std::string& output, const types::basic_cell_t<BoxSize>& cell, bool useSimpleFormat)
 {
-    std::cout << "╟";
-    printHorizontalLine(frame_width, "─");
-    std::cout << "┼";
-    printHorizontalLine(frame_width, "─");
-    std::cout << "┼";
-    printHorizontalLine(frame_width, "─");
-    std::cout << "╢\n";
+    if (cell.size() == 1) {
+        output += utils::getSingleCellValue(cell);
+    } else if (useSimpleFormat) {
+        output += '.';
+    } else {
+        output += '@';
+        for (auto it = cell.begin(); it != cell.end(); ++it) {
+            if (it != cell.begin()) {
+                output += ',';
+            }
+            output += *it;
+        }
+        output += '@';
+    }
 }
 
-static BoxStrings generateBoxStrings(const state_t& state, bool useSimpleFormat)
+template<size_t BoxSize>
+void renderState(const types::basic_state_t<BoxSize>& state, bool useSimpleFormat, std::string& output)
 {
-    auto boxStrings = BoxStrings();
-
-    std::stringstream stream;
-    size_t numProcessedElements = 0;
-    for (auto i = 0; i < state.cells.size(); ++i) {
-        for (auto j = 0; j < state.cells[i].size(); ++j) {
-            if (state.cells[i][j].size() == 1) {
-                stream << utils::getSingleCellValue(state.cells[i][j]);
-            } else if (useSimpleFormat) {
-                stream << '.';
-            } else {
-                stream << '@';
-                auto& possible_values = state.cells[i][j];
-                for (auto it = possible_values.begin(); it != possible_values.end(); ++it) {
-                    stream << *it;
-                    if (std::next(it) != possible_values.end()) {
-                        stream << ',';
-                    }
+    using grid = constants::Grid<BoxSize>;
+
+    // the cells of each row within each box, separated by spaces, all in one
+    // string; the frame is as wide as the longest of them
+    std::string segments;
+    std::array<size_t, grid::numRows * BoxSize + 1> ends;
+    ends[0] = 0;
+    size_t frameWidth = 0;
+    for (size_t i = 0; i < grid::numRows; ++i) {
+        for (size_t box = 0; box < BoxSize; ++box) {
+            for (size_t j = box * BoxSize; j < (box + 1) * BoxSize; ++j) {
+                if (j != box * BoxSize) {
+                    segments += ' ';
                 }
-                stream << '@';
-            }
-
-            ++numProcessedElements;
-
-            if (numProcessedElements != constants::boxSize) {
-                stream << ' ';
+                appendCell(segments, state.cells[i][j], useSimpleFormat);
             }
+            const auto segment = i * BoxSize + box;
+            ends[segment + 1] = segments.size();
+            frameWidth = std::max(frameWidth, ends[segment + 1] - ends[segment]);
+        }
+    }
 
-            if (numProcessedElements == constants::boxSize) {
-                auto box_line = stream.str();
-                if (box_line.length() > boxStrings.longest) {
-                    boxStrings.longest = box_line.length();
-                }
-                boxStrings.lines.emplace_back(box_line);
-                stream.str("");
-                stream.clear();
-                numProcessedElements = 0;
+    appendBoxLine(output, frameWidth, BoxSize, "╔", "╤", "╗");
+    for (size_t i = 0; i < grid::numRows; ++i) {
+        if ((i != 0) && ((i % BoxSize) == 0)) {
+            appendBoxLine(output, frameWidth, BoxSize, "╟", "┼", "╢", "─");
+        }
+        output += "║";
+        for (size_t box = 0; box < BoxSize; ++box) {
+            if (box != 0) {
+                output += "│";
             }
+            const auto segment = i * BoxSize + box;
+            output.append(segments, ends[segment], ends[segment + 1] - ends[segment]);
+            output.append(frameWidth - (ends[segment + 1] - ends[segment]), ' ');
         }
+        output += "║\n";
     }
-    return boxStrings;
+    appendBoxLine(output, frameWidth, BoxSize, "╚", "╧", "╝");
 }
 
-void printState(const state_t& state, bool useSimpleFormat)
+template<size_t BoxSize>
+void printState(const types::basic_state_t<BoxSize>& state, bool useSimpleFormat)
 {
-    const auto boxStrings = generateBoxStrings(state, useSimpleFormat);
-    const auto frame_width = boxStrings.longest;
-
-    printHeader(frame_width);
+    std::string output;
+    renderState(state, useSimpleFormat, output);
+    std::cout << output;
+}
 
-    size_t num_processed_lines = 0;
-    size_t row_index = 0;
-    for (const auto& line: boxStrings.lines) {
-        if (num_processed_lines == 0) {
-            std::cout << "║";
-        }
+template<size_t BoxSize>
+void appendValues(const types::basic_state_t<BoxSize>& state, std::string& output)
+{
+    using grid = constants::Grid<BoxSize>;
 
-        std::cout << std::left << std::setw(frame_width) << line;
-        ++num_processed_lines;
+    const auto start = output.size();
+    output.resize(start + grid::numElements);
+    storeValues(state, output.data() + start);
+}
 
-        if (num_processed_lines == constants::boxSize) {
-            std::cout << "║\n";
-            num_processed_lines = 0;
-            ++row_index;
-            if (((row_index % constants::boxSize) == 0) && (row_index != constants::numRows)) {
-                printMiddleHorizontalLine(frame_width);
-            }
-        } else {
-            std::cout << "│";
+template<size_t BoxSize>
+void storeValues(const types::basic_state_t<BoxSize>& state, char* values)
+{
+    for (const auto& row: state.cells) {
+        for (const auto& cell: row) {
+            *values++ = (cell.size() == 1) ? cell.single() : '.';
         }
     }
+}
 
-    printFooter(frame_width);
+template void renderState(const types::basic_state_t<2>& state, bool useSimpleFormat, std::string& output);
+template void renderState(const types::basic_state_t<3>& state, bool useSimpleFormat, std::string& output);
+template void renderState(const types::basic_state_t<4>& state, bool useSimpleFormat, std::string& output);
+template void renderState(const types::basic_state_t<5>& state, bool useSimpleFormat, std::string& output);
+template void appendValues(const types::basic_state_t<2>& state, std::string& output);
+template void appendValues(const types::basic_state_t<3>& state, std::string& output);
+template void appendValues(const types::basic_state_t<4>& state, std::string& output);
+template void appendValues(const types::basic_state_t<5>& state, std::string& output);
+template void storeValues(const types::basic_state_t<2>& state, char* values);
+template void storeValues(const types::basic_state_t<3>& state, char* values);
+template void storeValues(const types::basic_state_t<4>& state, char* values);
+template void storeValues(const types::basic_state_t<5>& state, char* values);
+template void printState(const types::basic_state_t<2>& state, bool useSimpleFormat);
+template void printState(const types::basic_state_t<3>& state, bool useSimpleFormat);
+template void printState(const types::basic_state_t<4>& state, bool useSimpleFormat);
+template void printState(const types::basic_state_t<5>& state, bool useSimpleFormat);
+
+void printStats(const Solver::Stats& stats, std::ostream& output)
+{
+    output << "Propagation passes: " << stats.propagationPasses << '\n'
+        << "Peer eliminations: " << stats.peerEliminations << '\n'
+        << "Naked singles: " << stats.nakedSingles << '\n'
+        << "Hidden singles: " << stats.hiddenSingles << '\n'
+        << "Intersection eliminations: " << stats.intersectionEliminations << '\n'
+        << "Naked subset eliminations: " << stats.nakedSubsetEliminations << '\n'
+        << "Hidden subset eliminations: " << stats.hiddenSubsetEliminations << '\n'
+        << "X-Wing eliminations: " << stats.xWingEliminations << '\n'
+        << "Branches created: " << stats.branchesCreated << '\n'
+        << "Branches tried: " << stats.branchesTried << '\n'
+        << "Backtracks: " << stats.backtracks << '\n'
+        << "Max depth: " << stats.maxDepth << '\n'
+        << "Propagation time: " << stats.propagationSeconds << " s\n"
+        << "Search time: " << stats.searchSeconds << " s\n";
+}
+
+void printCacheStats(const SolutionCache::Stats& stats, std::ostream& output)
+{
+    const auto hitRate = (stats.lookups != 0) ? 100.0 * stats.hits / stats.lookups : 0.0;
+    output << "Cache: " << stats.hits << " hits of " << stats.lookups << " lookups (" << hitRate << "%), "
+        << stats.entries << " of " << stats.capacity << " entries, " << (stats.bytes + 1023) / 1024 << " KiB\n";
 }
 
 }  // namespace display
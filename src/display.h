@@ -1,5 +1,9 @@
 #pragma once
 
+#include <ostream>
+#include <string>
+
+#include "solution_cache.h"
 #include "solver.h"
 #include "types.h"
 
@@ -9,9 +13,34 @@ namespace sudoku
 namespace display
 {
 
-using state_t = types::state_t;
+/** Append `state` to `output` as a grid framed by box-drawing characters.
+ *
+ *  A cell shows its value if it is known, otherwise '.' in the simple format
+ *  or all of its potential values between '@'s. */
+template<size_t BoxSize>
+void renderState(const types::basic_state_t<BoxSize>& state, bool useSimpleFormat, std::string& output);
+
+/** Write renderState() to stdout at once. */
+template<size_t BoxSize>
+void printState(const types::basic_state_t<BoxSize>& state, bool useSimpleFormat);
+
+/** Append the value of every cell, row by row, to `output`: the compact
+ *  format of a solution, '.' for the cells that are still unknown. The
+ *  buffer grows once per board, so appending many boards to the same one
+ *  hardly ever allocates. */
+template<size_t BoxSize>
+void appendValues(const types::basic_state_t<BoxSize>& state, std::string& output);
+
+/** Like appendValues(), but write the values to the grid::numElements
+ *  characters at `values`. */
+template<size_t BoxSize>
+void storeValues(const types::basic_state_t<BoxSize>& state, char* values);
+
+/** Print the counters of Solver::Stats, one per line. */
+void printStats(const Solver::Stats& stats, std::ostream& output);
 
-void printState(const state_t& state, bool useSimpleFormat);
+/** Print the hit rate and the memory of a SolutionCache on a single line. */
+void printCacheStats(const SolutionCache::Stats& stats, std::ostream& output);
 
 }  // namespace display
 
@@ -0,0 +1,232 @@
+#include <cassert>
+
+#include "dlx.h"
+#include "utils.h"
+
+
+namespace sudoku
+{
+
+template<size_t BoxSize>
+struct BasicDancingLinks<BoxSize>::Private
+{
+    using Self = BasicDancingLinks<BoxSize>;
+
+    static const auto boxSize = grid::boxSize;
+    static const auto numColumns = grid::numColumns;
+    static const auto numElements = grid::numElements;
+    static const auto numValues = grid::numValues;
+    static const index_t firstPlacementNode = 1 + numConstraints;
+
+    static index_t header(size_t constraint)
+    {
+        return static_cast<index_t>(1 + constraint);
+    }
+
+    static index_t firstNodeOfPlacement(size_t placement)
+    {
+        return static_cast<index_t>(firstPlacementNode + placement * constraintsPerPlacement);
+    }
+
+    static size_t placementOfNode(index_t node)
+    {
+        return (node - firstPlacementNode) / constraintsPerPlacement;
+    }
+
+    /** The 4 constraints satisfied by writing value number `value` (0 based)
+     *  into the cell at `index`. */
+    static std::array<size_t, constraintsPerPlacement> constraintsOf(size_t index, size_t value)
+    {
+        const auto row = index / numColumns;
+        const auto column = index % numColumns;
+        const auto box = (row / boxSize) * boxSize + column / boxSize;
+        return {
+            index,
+            numElements + row * numValues + value,
+            2 * numElements + column * numValues + value,
+            3 * numElements + box * numValues + value,
+        };
+    }
+
+    static void link(Self& self)
+    {
+        auto& nodes = self.nodes;
+        nodes.resize(numNodes);
+
+        for (index_t column = 0; column <= numConstraints; ++column) {
+            nodes[column].left = (column == 0) ? numConstraints : column - 1;
+            nodes[column].right = (column == numConstraints) ? 0 : column + 1;
+            nodes[column].up = column;
+            nodes[column].down = column;
+            nodes[column].column = column;
+            self.columnSizes[column] = 0;
+            self.columnCovered[column] = false;
+        }
+
+        for (size_t index = 0; index < numElements; ++index) {
+            for (size_t value = 0; value < numValues; ++value) {
+                const auto first = firstNodeOfPlacement(index * numValues + value);
+                const auto constraints = constraintsOf(index, value);
+                for (size_t k = 0; k < constraintsPerPlacement; ++k) {
+                    const auto node = static_cast<index_t>(first + k);
+                    const auto column = header(constraints[k]);
+                    nodes[node].left = (k == 0) ? first + constraintsPerPlacement - 1 : node - 1;
+                    nodes[node].right = (k == constraintsPerPlacement - 1) ? first : node + 1;
+                    nodes[node].column = column;
+                    nodes[node].down = column;
+                    nodes[node].up = nodes[column].up;
+                    nodes[nodes[column].up].down = node;
+                    nodes[column].up = node;
+                    ++self.columnSizes[column];
+                }
+            }
+        }
+    }
+
+    static void cover(Self& self, index_t column)
+    {
+        auto& nodes = self.nodes;
+        nodes[nodes[column].right].left = nodes[column].left;
+        nodes[nodes[column].left].right = nodes[column].right;
+        for (auto i = nodes[column].down; i != column; i = nodes[i].down) {
+            for (auto j = nodes[i].right; j != i; j = nodes[j].right) {
+                nodes[nodes[j].down].up = nodes[j].up;
+                nodes[nodes[j].up].down = nodes[j].down;
+                --self.columnSizes[nodes[j].column];
+            }
+        }
+        self.columnCovered[column] = true;
+        self.coveredColumns[self.numCovered++] = column;
+    }
+
+    static void uncover(Self& self, index_t column)
+    {
+        assert((self.numCovered != 0) && (self.coveredColumns[self.numCovered - 1] == column));
+        --self.numCovered;
+        auto& nodes = self.nodes;
+        for (auto i = nodes[column].up; i != column; i = nodes[i].up) {
+            for (auto j = nodes[i].left; j != i; j = nodes[j].left) {
+                ++self.columnSizes[nodes[j].column];
+                nodes[nodes[j].down].up = j;
+                nodes[nodes[j].up].down = j;
+            }
+        }
+        nodes[nodes[column].right].left = column;
+        nodes[nodes[column].left].right = column;
+        self.columnCovered[column] = false;
+    }
+
+    /** Uncover every column still covered, last covered first, which
+     *  brings the matrix back to what link() made of it. */
+    static void restore(Self& self)
+    {
+        while (self.numCovered != 0) {
+            uncover(self, self.coveredColumns[self.numCovered - 1]);
+        }
+        self.solutionSize = 0;
+    }
+
+    /** Take a given of the board: cover every constraint it satisfies.
+     *
+     *  Returns false if one of them is already satisfied by another given. */
+    static bool select(Self& self, size_t index, size_t value)
+    {
+        const auto first = firstNodeOfPlacement(index * numValues + value);
+        for (size_t k = 0; k < constraintsPerPlacement; ++k) {
+            const auto column = self.nodes[first + k].column;
+            if (self.columnCovered[column]) {
+                return false;
+            }
+            cover(self, column);
+        }
+        return true;
+    }
+
+    /** The uncovered constraint with the fewest placements left. */
+    static index_t chooseColumn(const Self& self)
+    {
+        auto best = self.nodes[root].right;
+        for (auto column = self.nodes[best].right; column != root; column = self.nodes[column].right) {
+            if (self.columnSizes[column] < self.columnSizes[best]) {
+                best = column;
+                if (self.columnSizes[best] <= 1) {
+                    break;
+                }
+            }
+        }
+        return best;
+    }
+
+    static bool search(Self& self)
+    {
+        auto& nodes = self.nodes;
+        if (nodes[root].right == root) {
+            return true;
+        }
+
+        const auto column = chooseColumn(self);
+        if (self.columnSizes[column] == 0) {
+            return false;
+        }
+
+        cover(self, column);
+        for (auto row = nodes[column].down; row != column; row = nodes[row].down) {
+            self.solution[self.solutionSize++] = row;
+            for (auto j = nodes[row].right; j != row; j = nodes[j].right) {
+                cover(self, nodes[j].column);
+            }
+
+            if (search(self)) {
+                return true;
+            }
+
+            for (auto j = nodes[row].left; j != row; j = nodes[j].left) {
+                uncover(self, nodes[j].column);
+            }
+            --self.solutionSize;
+        }
+        uncover(self, column);
+
+        return false;
+    }
+};
+
+
+template<size_t BoxSize>
+bool BasicDancingLinks<BoxSize>::solve(types::basic_state_t<BoxSize>& state)
+{
+    if (nodes.empty()) {
+        Private::link(*this);
+    }
+
+    auto solved = true;
+    for (size_t index = 0; solved && (index < Private::numElements); ++index) {
+        const auto& cell = state.cells[index / Private::numColumns][index % Private::numColumns];
+        if (cell.size() == 1) {
+            const auto value = grid::indexOf(utils::getSingleCellValue(cell));
+            solved = Private::select(*this, index, value);
+        }
+    }
+    solved = solved && Private::search(*this);
+
+    if (solved) {
+        for (size_t i = 0; i < solutionSize; ++i) {
+            const auto placement = Private::placementOfNode(solution[i]);
+            const auto index = placement / Private::numValues;
+            auto& cell = state.cells[index / Private::numColumns][index % Private::numColumns];
+            cell.clear();
+            cell.emplace(grid::symbol(placement % Private::numValues));
+        }
+        state.remaining = 0;
+    }
+    Private::restore(*this);
+
+    return solved;
+}
+
+template class BasicDancingLinks<2>;
+template class BasicDancingLinks<3>;
+template class BasicDancingLinks<4>;
+template class BasicDancingLinks<5>;
+
+}  // namespace sudoku
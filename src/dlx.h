@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "constants.h"
+#include "types.h"
+
+
+namespace sudoku
+{
+
+/** Knuth's Algorithm X on dancing links.
+ *
+ *  Sudoku is modelled as an exact cover problem: every placement of a value
+ *  into a cell is a row of the matrix, covering 4 of the constraints (the
+ *  cell is filled, and the value appears in the row, the column and the
+ *  box), 324 of them on a 9x9 grid. The links are indices into an array
+ *  of nodes, allocated and linked by the first solve(). Every solve()
+ *  undoes its covers before it returns, so a single instance solves one
+ *  board after the other without allocating or relinking. */
+template<size_t BoxSize>
+class BasicDancingLinks
+{
+    using grid = constants::Grid<BoxSize>;
+    using index_t = std::uint16_t;
+
+    struct Node
+    {
+        index_t left;
+        index_t right;
+        index_t up;
+        index_t down;
+        index_t column;
+    };
+
+    static const size_t constraintsPerPlacement = 4;
+    static const size_t numConstraints = constraintsPerPlacement * grid::numElements;
+    static const size_t numPlacements = grid::numElements * grid::numValues;
+    // the root, one header per constraint and the nodes of every placement
+    static const size_t numNodes = 1 + numConstraints + constraintsPerPlacement * numPlacements;
+    static const index_t root = 0;
+    static_assert(numNodes <= 65536, "every node must have an index_t");
+
+    std::vector<Node> nodes;
+    std::array<index_t, numConstraints + 1> columnSizes;
+    std::array<bool, numConstraints + 1> columnCovered;
+    // the covered columns in the order of their covering, to undo them
+    std::array<index_t, numConstraints> coveredColumns;
+    size_t numCovered = 0;
+    std::array<index_t, grid::numElements> solution;
+    size_t solutionSize = 0;
+
+    struct Private;
+
+public:
+    /** Solve the board represented by the fixed cells of `state`.
+     *
+     *  On success every cell of `state` is fixed to its value in the
+     *  solution, otherwise `state` is left untouched and false is returned. */
+    bool solve(types::basic_state_t<BoxSize>& state);
+};
+
+using DancingLinks = BasicDancingLinks<constants::boxSize>;
+
+}  // namespace sudoku
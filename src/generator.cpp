@@ -0,0 +1,281 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "constants.h"
+#include "generator.h"
+#include "solver.h"
+#include "thread_pool.h"
+
+
+namespace sudoku
+{
+
+struct Generator::Private
+{
+    using cell_t = types::cell_t;
+    using state_t = types::state_t;
+    using puzzle_t = std::array<char, constants::numElements>;
+
+    // puzzles generated by a single task of the thread pool
+    static constexpr size_t chunkPuzzles = 64;
+    // chunks that may be generated ahead of the first unwritten one, per worker
+    static const size_t chunksInFlightPerWorker = 4;
+    // complete grids tried for a puzzle before settling for more clues than the target
+    static const size_t maxGridsPerPuzzle = 1000;
+
+    static constexpr cell_t::mask_t allValues = (1u << constants::numValues) - 1;
+
+    struct Counters
+    {
+        size_t numPuzzles = 0;
+        size_t numAtTarget = 0;
+        size_t numClues = 0;
+
+        Counters& operator+=(const Counters& other)
+        {
+            numPuzzles += other.numPuzzles;
+            numAtTarget += other.numAtTarget;
+            numClues += other.numClues;
+            return *this;
+        }
+    };
+
+    struct Chunk
+    {
+        size_t first = 0;
+        size_t count = 0;
+        std::string output;
+        Counters counters;
+    };
+
+    /** Everything a worker needs to generate a puzzle, reused from puzzle to puzzle. */
+    struct Worker
+    {
+        Solver solver;
+        state_t state;
+        std::mt19937_64 random;
+    };
+
+    /** A number in [0, bound), the same on every standard library. */
+    static size_t below(Worker& worker, size_t bound)
+    {
+        return worker.random() % bound;
+    }
+
+    template<typename Container>
+    static void shuffle(Worker& worker, Container& container)
+    {
+        for (auto i = container.size(); i > 1; --i) {
+            std::swap(container[i - 1], container[below(worker, i)]);
+        }
+    }
+
+    /** The seed of puzzle number `index` (splitmix64), so that puzzles don't
+     *  depend on the order in which the threads generate them. */
+    static std::uint64_t seedOf(std::uint64_t seed, size_t index)
+    {
+        auto z = seed + (index + 1) * 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    /** A random complete grid: the boxes on the diagonal don't share any
+     *  row or column, so they are filled with random permutations and the
+     *  solver completes the rest. */
+    static void fillGrid(Worker& worker, puzzle_t& grid)
+    {
+        for (auto& row: worker.state.cells) {
+            row.fill(cell_t(allValues));
+        }
+        worker.state.remaining = constants::numElements;
+        std::array<size_t, constants::numValues> values;
+        std::iota(values.begin(), values.end(), 0);
+        for (size_t box = 0; box < constants::boxSize; ++box) {
+            shuffle(worker, values);
+            for (size_t i = 0; i < constants::numValues; ++i) {
+                const auto row = box * constants::boxSize + i / constants::boxSize;
+                const auto column = box * constants::boxSize + i % constants::boxSize;
+                worker.state.cells[row][column] = cell_t(cell_t::mask_t(1u << values[i]));
+                --worker.state.remaining;
+            }
+        }
+
+        worker.solver.load(worker.state);
+        const auto board = worker.solver.solve();
+        for (size_t index = 0; index < constants::numElements; ++index) {
+            grid[index] = board[index / constants::numColumns][index % constants::numColumns];
+        }
+    }
+
+    /** Whether the clues of `puzzle` without the one at `index` still have a
+     *  unique solution.
+     *
+     *  The puzzle has a solution, so there is another one only if the value
+     *  of the removed clue can be avoided: a single search for a solution
+     *  without that value decides it. */
+    static bool isUniqueWithout(Worker& worker, const puzzle_t& puzzle, size_t index)
+    {
+        auto& state = worker.state;
+        state.remaining = 0;
+        for (size_t i = 0; i < constants::numElements; ++i) {
+            auto& cell = state.cells[i / constants::numColumns][i % constants::numColumns];
+            if (puzzle[i] == '.') {
+                cell = cell_t(allValues);
+                ++state.remaining;
+            } else {
+                cell = cell_t();
+                cell.emplace(puzzle[i]);
+            }
+        }
+        auto& removed = state.cells[index / constants::numColumns][index % constants::numColumns];
+        removed = cell_t(allValues);
+        removed.erase(puzzle[index]);
+        ++state.remaining;
+
+        worker.solver.load(state);
+        return worker.solver.countSolutions(1) == 0;
+    }
+
+    /** Remove the clues of the complete grid in `puzzle` in a random order,
+     *  down to `target` clues or as long as the solution stays unique.
+     *  Returns the number of clues left. */
+    static size_t removeClues(Worker& worker, puzzle_t& puzzle, size_t target)
+    {
+        std::array<size_t, constants::numElements> order;
+        std::iota(order.begin(), order.end(), 0);
+        shuffle(worker, order);
+
+        auto clues = constants::numElements;
+        for (const auto index: order) {
+            if (clues <= target) {
+                break;
+            }
+            if (isUniqueWithout(worker, puzzle, index)) {
+                puzzle[index] = '.';
+                --clues;
+            }
+        }
+        return clues;
+    }
+
+    static void generatePuzzle(Worker& worker, const Options& options, size_t index, std::string& output,
+        Counters& counters)
+    {
+        worker.random.seed(seedOf(options.seed, index));
+
+        puzzle_t best;
+        auto bestClues = constants::numElements + 1;
+        for (size_t attempt = 0; (attempt < maxGridsPerPuzzle) && (bestClues > options.clues); ++attempt) {
+            puzzle_t puzzle;
+            fillGrid(worker, puzzle);
+            const auto clues = removeClues(worker, puzzle, options.clues);
+            if (clues < bestClues) {
+                best = puzzle;
+                bestClues = clues;
+            }
+            if (options.clues == 0) {
+                break;
+            }
+        }
+
+        output.append(best.begin(), best.end());
+        output += '\n';
+        ++counters.numPuzzles;
+        counters.numClues += bestClues;
+        if ((options.clues == 0) || (bestClues == options.clues)) {
+            ++counters.numAtTarget;
+        }
+    }
+
+    static void generateChunk(Worker& worker, const Options& options, Chunk& chunk)
+    {
+        for (size_t i = 0; i < chunk.count; ++i) {
+            generatePuzzle(worker, options, chunk.first + i, chunk.output, chunk.counters);
+        }
+    }
+
+    static Counters runSequential(Generator& self)
+    {
+        Counters counters;
+        Worker worker;
+        Chunk chunk;
+        for (size_t first = 0; first < self.options.count; first += chunkPuzzles) {
+            chunk.first = first;
+            chunk.count = std::min(chunkPuzzles, self.options.count - first);
+            chunk.output.clear();
+            chunk.counters = Counters();
+            generateChunk(worker, self.options, chunk);
+            self.output << chunk.output;
+            counters += chunk.counters;
+        }
+        return counters;
+    }
+
+    static Counters runParallel(Generator& self)
+    {
+        ThreadPool pool(self.options.numThreads);
+        std::vector<Worker> workers(pool.size());
+
+        Counters counters;
+        // written strictly in the order of the puzzles, like the results of Batch
+        OrderedChunks<Chunk> chunks(pool, chunksInFlightPerWorker * pool.size(),
+            [&](Chunk& chunk, size_t workerIndex) {
+                generateChunk(workers[workerIndex], self.options, chunk);
+            },
+            [&](Chunk& chunk) {
+                self.output << chunk.output;
+                counters += chunk.counters;
+            });
+
+        for (size_t first = 0; first < self.options.count; first += chunkPuzzles) {
+            auto chunk = chunks.next();
+            chunk->first = first;
+            chunk->count = std::min(chunkPuzzles, self.options.count - first);
+            chunk->output.clear();
+            chunk->counters = Counters();
+            chunks.submit(std::move(chunk));
+        }
+        chunks.finish();
+
+        return counters;
+    }
+};
+
+
+Generator::Generator(std::ostream& output, const Options& options)
+    : output(output)
+    , options(options)
+{}
+
+Generator::~Generator()
+{}
+
+int Generator::run()
+{
+    std::ios::sync_with_stdio(false);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    const auto counters = (options.numThreads == 1) ? Private::runSequential(*this) : Private::runParallel(*this);
+    output.flush();
+
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const auto throughput = (elapsed > 0.0) ? counters.numPuzzles / elapsed : 0.0;
+    const auto averageClues = (counters.numPuzzles != 0) ? double(counters.numClues) / counters.numPuzzles : 0.0;
+    std::cerr << "Puzzles: " << counters.numPuzzles << " (average clues: " << averageClues;
+    if (options.clues != 0) {
+        std::cerr << ", with " << options.clues << " clues: " << counters.numAtTarget;
+    }
+    std::cerr << ") in " << elapsed << " s, " << throughput << " puzzles/s\n";
+
+    return (counters.numAtTarget == counters.numPuzzles) ? 0 : 2;
+}
+
+}  // namespace sudoku
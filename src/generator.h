@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+
+#include "interface.h"
+
+
+namespace sudoku
+{
+
+/** Generate 9x9 puzzles with a unique solution, one per line in the format
+ *  of 81 characters that Batch reads, '.' for an unknown cell.
+ *
+ *  Every puzzle starts from a random complete grid. Its clues are removed
+ *  one at a time in a random order, and a removal is undone if the
+ *  solution would no longer be unique. Without a target number of clues
+ *  every clue is tried once, so the puzzles are minimal: removing any
+ *  further clue gives more than one solution.
+ *
+ *  Puzzle number `i` only depends on the seed and on `i`, so the output is
+ *  the same whatever the number of threads. The number of puzzles and the
+ *  throughput are reported on stderr at the end. */
+class Generator: public Interface
+{
+public:
+    struct Options
+    {
+        size_t count = 1;
+        /// stop removing clues at this many, zero for minimal puzzles; a grid
+        /// whose minimal puzzles keep more clues is dropped for another one
+        size_t clues = 0;
+        std::uint64_t seed = 0;
+        /// zero means one per hardware thread
+        size_t numThreads = 1;
+    };
+
+    Generator(std::ostream& output, const Options& options);
+    ~Generator();
+
+    /** Returns 0 if every puzzle has the target number of clues, 2 otherwise. */
+    int run() override;
+
+private:
+    std::ostream& output;
+    Options options;
+    struct Private;
+};
+
+}  // namespace sudoku
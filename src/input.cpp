@@ -0,0 +1,100 @@
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "input.h"
+
+
+namespace sudoku
+{
+
+namespace input
+{
+
+MappedFile::MappedFile(const std::string& path)
+{
+    const auto fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "Can't open " + path);
+    }
+
+    struct stat status;
+    if (::fstat(fd, &status) != 0) {
+        const auto error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "Can't stat " + path);
+    }
+    if (!S_ISREG(status.st_mode)) {
+        ::close(fd);
+        throw std::system_error(ENODEV, std::generic_category(), "Can't map " + path);
+    }
+
+    size = static_cast<size_t>(status.st_size);
+    if (size != 0) {
+        auto mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            const auto error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "Can't map " + path);
+        }
+        ::madvise(mapping, size, MADV_SEQUENTIAL);
+        data = static_cast<const char*>(mapping);
+    }
+
+    // the mapping stays valid without the descriptor
+    ::close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (data != nullptr) {
+        ::munmap(const_cast<char*>(data), size);
+    }
+}
+
+std::string_view MappedFile::contents() const
+{
+    return std::string_view(data, size);
+}
+
+bool isRegularFile(const std::string& path)
+{
+    struct stat status;
+    return (::stat(path.c_str(), &status) == 0) && S_ISREG(status.st_mode);
+}
+
+std::string_view nextLine(std::string_view& text)
+{
+    const auto end = text.find('\n');
+    auto line = text.substr(0, end);
+    text.remove_prefix((end == std::string_view::npos) ? text.size() : end + 1);
+
+    while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back()))) {
+        line.remove_suffix(1);
+    }
+    return line;
+}
+
+std::string_view takeLines(std::string_view& text, size_t numBytes)
+{
+    if (numBytes >= text.size()) {
+        return std::exchange(text, std::string_view());
+    }
+
+    const auto end = text.find('\n', numBytes);
+    const auto length = (end == std::string_view::npos) ? text.size() : end + 1;
+    const auto lines = text.substr(0, length);
+    text.remove_prefix(length);
+    return lines;
+}
+
+}  // namespace input
+
+}  // namespace sudoku
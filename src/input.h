@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+
+
+namespace sudoku
+{
+
+namespace input
+{
+
+/** A read-only memory mapping of a whole file.
+ *
+ *  Boards can be parsed straight from the mapped bytes, without copying
+ *  the file into strings first. Throws std::system_error if the file can't
+ *  be mapped, which includes anything but a regular file: pipes and FIFOs
+ *  have no size to map, see isRegularFile(). */
+class MappedFile
+{
+    const char* data = nullptr;
+    size_t size = 0;
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string_view contents() const;
+};
+
+/** Whether `path` names a regular file, following symbolic links; false
+ *  if it doesn't exist. */
+bool isRegularFile(const std::string& path);
+
+/** Remove the first line from `text` and return it without the line break
+ *  and trailing whitespace. */
+std::string_view nextLine(std::string_view& text);
+
+/** Remove at least `numBytes` from the front of `text`, up to the end of a
+ *  line, and return them. Consecutive calls split a text into ranges of
+ *  whole lines that can be processed independently. */
+std::string_view takeLines(std::string_view& text, size_t numBytes);
+
+}  // namespace input
+
+}  // namespace sudoku
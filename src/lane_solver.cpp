@@ -0,0 +1,275 @@
+#include <algorithm>
+#include <cstring>
+
+#include "lane_solver.h"
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+// the vectors never cross the boundary of this file, their ABI doesn't matter
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+
+namespace sudoku
+{
+
+namespace
+{
+
+const auto boxSize = constants::boxSize;
+const auto numRows = constants::numRows;
+const auto numColumns = constants::numColumns;
+const auto numElements = constants::numElements;
+const auto numValues = constants::numValues;
+const size_t numUnits = numRows + numColumns + constants::numBoxes;
+
+using mask_t = LaneSolver::mask_t;
+const mask_t allValues = (1u << numValues) - 1;
+
+// one mask per board, the width of an AVX2 register
+typedef mask_t lanes_t __attribute__((vector_size(LaneSolver::numLanes * sizeof(mask_t))));
+typedef std::int16_t signed_lanes_t __attribute__((vector_size(LaneSolver::numLanes * sizeof(mask_t))));
+
+using unit_t = std::array<std::uint8_t, numValues>;
+using units_t = std::array<unit_t, numUnits>;
+
+/** Rows first, then columns, then boxes. */
+constexpr units_t createUnits()
+{
+    units_t units{};
+    for (size_t cell = 0; cell < numElements; ++cell) {
+        const auto row = cell / numColumns;
+        const auto column = cell % numColumns;
+        const auto box = (row / boxSize) * boxSize + column / boxSize;
+        const auto positionInBox = (row % boxSize) * boxSize + column % boxSize;
+        units[row][column] = static_cast<std::uint8_t>(cell);
+        units[numRows + column][row] = static_cast<std::uint8_t>(cell);
+        units[numRows + numColumns + box][positionInBox] = static_cast<std::uint8_t>(cell);
+    }
+    return units;
+}
+
+constexpr units_t units = createUnits();
+
+inline lanes_t splat(mask_t value)
+{
+    lanes_t lanes;
+    for (size_t lane = 0; lane < LaneSolver::numLanes; ++lane) {
+        lanes[lane] = value;
+    }
+    return lanes;
+}
+
+/** All bits set in the lanes that are zero, none elsewhere. */
+inline lanes_t whereZero(lanes_t lanes)
+{
+    return reinterpret_cast<lanes_t>(static_cast<signed_lanes_t>(lanes == 0));
+}
+
+inline bool anyLane(lanes_t lanes)
+{
+    mask_t any = 0;
+    for (size_t lane = 0; lane < LaneSolver::numLanes; ++lane) {
+        any |= lanes[lane];
+    }
+    return any != 0;
+}
+
+/** The kernel of LaneSolver::propagate(), inlined into a copy per instruction set.
+ *
+ *  `failed` gets all bits set in the lanes that turned out contradictory:
+ *  a cell without values, a value fixed twice in a unit, or a value that
+ *  has no place in a unit. The bits of every cell only ever get cleared,
+ *  so the loop terminates. */
+[[gnu::always_inline]] inline void propagateLanes(lanes_t* cells, lanes_t& failed)
+{
+    const auto all = splat(allValues);
+    const auto one = splat(1);
+
+    failed = lanes_t{};
+    bool changed = true;
+    while (changed) {
+        auto changes = lanes_t{};
+
+        // peer elimination: every unit collects the values fixed in it
+        std::array<lanes_t, numUnits> fixed;
+        for (size_t unit = 0; unit < numUnits; ++unit) {
+            auto seen = lanes_t{};
+            auto seenTwice = lanes_t{};
+            for (const auto cell: units[unit]) {
+                const auto value = cells[cell];
+                const auto single = value & whereZero(value & (value - one));
+                seenTwice |= seen & single;
+                seen |= single;
+            }
+            failed |= seenTwice;
+            fixed[unit] = seen;
+        }
+        for (size_t cell = 0; cell < numElements; ++cell) {
+            const auto row = cell / numColumns;
+            const auto column = cell % numColumns;
+            const auto box = (row / boxSize) * boxSize + column / boxSize;
+            const auto value = cells[cell];
+            const auto unknown = ~whereZero(value & (value - one));
+            const auto erased = (fixed[row] | fixed[numRows + column] | fixed[numRows + numColumns + box]) & unknown;
+            const auto reduced = value & ~erased;
+            changes |= value ^ reduced;
+            cells[cell] = reduced;
+        }
+
+        // hidden singles: values with a single place in a unit
+        for (size_t unit = 0; unit < numUnits; ++unit) {
+            auto seen = lanes_t{};
+            auto seenTwice = lanes_t{};
+            for (const auto cell: units[unit]) {
+                seenTwice |= seen & cells[cell];
+                seen |= cells[cell];
+            }
+            failed |= all & ~seen;
+            const auto once = seen & ~seenTwice;
+            for (const auto cell: units[unit]) {
+                const auto value = cells[cell];
+                const auto hidden = value & once;
+                // two values that only fit into the same cell
+                failed |= ~whereZero(hidden & (hidden - one));
+                const auto reduced = (hidden & ~whereZero(hidden)) | (value & whereZero(hidden));
+                changes |= value ^ reduced;
+                cells[cell] = reduced;
+            }
+        }
+
+        for (size_t cell = 0; cell < numElements; ++cell) {
+            failed |= whereZero(cells[cell]);
+        }
+
+        changed = anyLane(changes & ~failed);
+    }
+}
+
+void propagateGeneric(lanes_t* cells, lanes_t& failed)
+{
+    propagateLanes(cells, failed);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SUDOKU_LANES_AVX2
+
+__attribute__((target("avx2")))
+void propagateAvx2(lanes_t* cells, lanes_t& failed)
+{
+    propagateLanes(cells, failed);
+}
+#endif
+
+using kernel_t = void (*)(lanes_t*, lanes_t&);
+
+struct Kernel
+{
+    kernel_t function;
+    const char* name;
+};
+
+Kernel selectKernel()
+{
+#ifdef SUDOKU_LANES_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {propagateAvx2, "avx2"};
+    }
+#endif
+    return {propagateGeneric, "generic"};
+}
+
+const Kernel kernel = selectKernel();
+
+}  // namespace
+
+
+LaneSolver::LaneSolver()
+{
+    clear();
+}
+
+void LaneSolver::clear()
+{
+    for (auto& cell: cells) {
+        cell.fill(allValues);
+    }
+    statuses.fill(Status::NeedsSearch);
+}
+
+void LaneSolver::load(lane_t lane, const types::board_t& board)
+{
+    for (size_t i = 0; i < numRows; ++i) {
+        for (size_t j = 0; j < numColumns; ++j) {
+            const auto value = board[i][j];
+            cells[i * numColumns + j][lane] = (value == '.') ? allValues : static_cast<mask_t>(1u << (value - '1'));
+        }
+    }
+}
+
+void LaneSolver::load(lane_t lane, const types::state_t& state)
+{
+    for (size_t i = 0; i < numRows; ++i) {
+        for (size_t j = 0; j < numColumns; ++j) {
+            cells[i * numColumns + j][lane] = state.cells[i][j].bits();
+        }
+    }
+}
+
+void LaneSolver::propagate()
+{
+    static_assert(sizeof(lanes_t) == sizeof(cells[0]));
+
+    lanes_t lanes[numElements];
+    std::memcpy(lanes, cells.data(), sizeof(lanes));
+    lanes_t failed;
+    kernel.function(lanes, failed);
+    std::memcpy(cells.data(), lanes, sizeof(lanes));
+
+    for (lane_t lane = 0; lane < numLanes; ++lane) {
+        const auto solved = std::all_of(cells.begin(), cells.end(), [lane](const auto& cell) {
+            return std::has_single_bit(cell[lane]);
+        });
+        if (failed[lane] != 0) {
+            statuses[lane] = Status::Contradiction;
+        } else if (solved) {
+            statuses[lane] = Status::Solved;
+        } else {
+            statuses[lane] = Status::NeedsSearch;
+        }
+    }
+}
+
+LaneSolver::Status LaneSolver::status(lane_t lane) const
+{
+    return statuses[lane];
+}
+
+void LaneSolver::store(lane_t lane, types::state_t& state) const
+{
+    state.remaining = 0;
+    for (size_t i = 0; i < numRows; ++i) {
+        for (size_t j = 0; j < numColumns; ++j) {
+            const auto cell = types::cell_t(cells[i * numColumns + j][lane]);
+            state.cells[i][j] = cell;
+            if (cell.size() != 1) {
+                ++state.remaining;
+            }
+        }
+    }
+}
+
+void LaneSolver::storeSolution(lane_t lane, char* values) const
+{
+    for (size_t cell = 0; cell < numElements; ++cell) {
+        values[cell] = types::cell_t(cells[cell][lane]).single();
+    }
+}
+
+const char* LaneSolver::implementation()
+{
+    return kernel.name;
+}
+
+}  // namespace sudoku
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "constants.h"
+#include "types.h"
+
+
+namespace sudoku
+{
+
+/** Constraint propagation on 16 boards at once.
+ *
+ *  The potential values of the boards are interleaved (cell by cell, one
+ *  16-bit lane per board), so peer elimination and hidden singles over the
+ *  27 units run as uniform bit operations on all boards together. On x86
+ *  the kernel is compiled for AVX2 as well and picked at runtime; other
+ *  CPUs use the same kernel built for the baseline instruction set.
+ *
+ *  Propagation alone solves most boards. A board that needs a search is
+ *  meant to be handed over to a Solver with its reduced state, see store(). */
+class LaneSolver
+{
+public:
+    static const size_t numLanes = 16;
+
+    enum class Status
+    {
+        Solved,
+        NeedsSearch,
+        Contradiction,
+    };
+
+    using lane_t = size_t;
+
+    LaneSolver();
+
+    /** Empty every lane. */
+    void clear();
+
+    /** Put a board into a lane, '.' marking an unknown cell. */
+    void load(lane_t lane, const types::board_t& board);
+
+    /** Put the potential values of a solver state into a lane. */
+    void load(lane_t lane, const types::state_t& state);
+
+    /** Propagate every lane to a fixpoint. */
+    void propagate();
+
+    Status status(lane_t lane) const;
+
+    /** The reduced state of a lane after propagate(). */
+    void store(lane_t lane, types::state_t& state) const;
+
+    /** Write the solution of a Solved lane, one character per cell. */
+    void storeSolution(lane_t lane, char* values) const;
+
+    /** The instruction set the kernel runs with on this CPU. */
+    static const char* implementation();
+
+    using mask_t = types::cell_t::mask_t;
+
+private:
+    alignas(32) std::array<std::array<mask_t, numLanes>, constants::numElements> cells;
+    std::array<Status, numLanes> statuses;
+};
+
+}  // namespace sudoku
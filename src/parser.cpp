@@ -0,0 +1,394 @@
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "constants.h"
+#include "parser.h"
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+// the vectors never cross the boundary of this file, their ABI doesn't matter
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+
+namespace sudoku
+{
+
+namespace parser
+{
+
+namespace
+{
+
+const auto boxSize = constants::boxSize;
+const auto numColumns = constants::numColumns;
+const auto numElements = constants::numElements;
+const auto numValues = constants::numValues;
+
+using cell_t = types::cell_t;
+using mask_t = cell_t::mask_t;
+const mask_t allValues = (1u << numValues) - 1;
+
+// 16 characters of a line, checked at once
+typedef signed char chars_t __attribute__((vector_size(16)));
+
+/** The potential values of a 9x9 cell written as each character, zero for
+ *  the characters that aren't a cell. */
+constexpr std::array<mask_t, 256> createCellMasks()
+{
+    std::array<mask_t, 256> masks{};
+    masks['.'] = allValues;
+    masks['0'] = allValues;
+    for (size_t value = 0; value < numValues; ++value) {
+        masks[static_cast<unsigned char>(constants::symbols[value])] = static_cast<mask_t>(1u << value);
+    }
+    return masks;
+}
+
+constexpr auto cellMasks = createCellMasks();
+
+/** Whether the 16 characters at `text` are all cells of a 9x9 board. */
+inline bool areCells(const char* text)
+{
+    chars_t chars;
+    std::memcpy(&chars, text, sizeof(chars));
+    const chars_t valid = ((chars >= '0') & (chars <= '9')) | (chars == '.');
+
+    std::uint64_t halves[2];
+    std::memcpy(halves, &valid, sizeof(halves));
+    return (halves[0] & halves[1]) == ~std::uint64_t(0);
+}
+
+bool fail(Error& error, size_t position, std::string message)
+{
+    error.position = position;
+    error.message = std::move(message);
+    return false;
+}
+
+bool unexpected(Error& error, size_t position, char ch)
+{
+    return fail(error, position, std::string("Unexpected character '") + ch + "'");
+}
+
+bool repeated(Error& error, size_t position, char value, const char* unit, size_t unitIndex)
+{
+    return fail(error, position, std::string("The value ") + value + " repeats in " + unit + ' ' +
+        std::to_string(unitIndex + 1));
+}
+
+/** The size of the boxes of a grid with `numValues` values, zero if no
+ *  such grid is supported. */
+size_t boxSizeOf(size_t numValues)
+{
+    for (auto boxSize = constants::minBoxSize; boxSize <= constants::maxBoxSize; ++boxSize) {
+        if (boxSize * boxSize == numValues) {
+            return boxSize;
+        }
+    }
+    return 0;
+}
+
+bool isSymbol(size_t boxSize, char ch)
+{
+    switch (boxSize) {
+        case 2:
+            return constants::Grid<2>::isSymbol(ch);
+        case 3:
+            return constants::Grid<3>::isSymbol(ch);
+        case 4:
+            return constants::Grid<4>::isSymbol(ch);
+        case 5:
+            return constants::Grid<5>::isSymbol(ch);
+        default:
+            return false;
+    }
+}
+
+/** Check the characters of a square `board` ('0' is turned into '.') and
+ *  its givens. `positionOf(i, j)` is the offset of a cell in the text. */
+template<typename PositionOf>
+bool validate(types::board_t& board, PositionOf positionOf, Error& error)
+{
+    const auto boxSize = boxSizeOf(board.size());
+    std::array<std::uint32_t, constants::Grid<constants::maxBoxSize>::numValues> rows{};
+    auto columns = rows;
+    auto boxes = rows;
+    for (size_t i = 0; i < board.size(); ++i) {
+        for (size_t j = 0; j < board.size(); ++j) {
+            auto& ch = board[i][j];
+            if (ch == '0') {
+                ch = '.';
+            }
+            if (ch == '.') {
+                continue;
+            }
+            if (!isSymbol(boxSize, ch)) {
+                return unexpected(error, positionOf(i, j), ch);
+            }
+
+            const auto bit = std::uint32_t(1) << constants::Grid<constants::maxBoxSize>::indexOf(ch);
+            const auto box = (i / boxSize) * boxSize + j / boxSize;
+            if ((rows[i] & bit) != 0) {
+                return repeated(error, positionOf(i, j), ch, "row", i);
+            }
+            if ((columns[j] & bit) != 0) {
+                return repeated(error, positionOf(i, j), ch, "column", j);
+            }
+            if ((boxes[box] & bit) != 0) {
+                return repeated(error, positionOf(i, j), ch, "box", box);
+            }
+            rows[i] |= bit;
+            columns[j] |= bit;
+            boxes[box] |= bit;
+        }
+    }
+    return true;
+}
+
+/** A board of all the cells in a row, starting at `offset` of the text. */
+bool parseCells(std::string_view text, size_t offset, types::board_t& board, Error& error)
+{
+    size_t size = 0;
+    while (size * size < text.size()) {
+        ++size;
+    }
+    if ((size * size != text.size()) || (boxSizeOf(size) == 0)) {
+        return fail(error, offset + text.size(),
+            "Expected a board of 16, 81, 256 or 625 characters, got " + std::to_string(text.size()));
+    }
+
+    board.resize(size);
+    for (size_t i = 0; i < size; ++i) {
+        board[i].assign(text.begin() + i * size, text.begin() + (i + 1) * size);
+    }
+    return validate(board, [offset, size](size_t i, size_t j) { return offset + i * size + j; }, error);
+}
+
+/** Reads a JSON array of rows, keeping track of the position in the text. */
+class ArrayReader
+{
+public:
+    ArrayReader(std::string_view text, Error& error): text(text), error(error)
+    {}
+
+    bool read(types::board_t& board)
+    {
+        // the offsets of the cells, for the errors of validate()
+        thread_local std::vector<size_t> positions;
+        positions.clear();
+
+        size_t numRows = 0;
+        skipSpaces();
+        if (!take('[')) {
+            return expected("'['");
+        }
+        do {
+            skipSpaces();
+            if (numRows == board.size()) {
+                board.emplace_back();
+            }
+            auto& row = board[numRows++];
+            row.clear();
+            if (!readRow(row, positions)) {
+                return false;
+            }
+            if (row.size() != board.front().size()) {
+                return fail(error, position - 1, "Expected " + std::to_string(board.front().size()) +
+                    " cells in row " + std::to_string(numRows) + ", got " + std::to_string(row.size()));
+            }
+            skipSpaces();
+        } while (take(','));
+        if (!take(']')) {
+            return expected("',' or ']'");
+        }
+        const auto end = position - 1;
+        skipSpaces();
+        if (position != text.size()) {
+            return unexpected(error, position, text[position]);
+        }
+
+        board.resize(numRows);
+        const auto size = board.front().size();
+        if ((numRows != size) || (boxSizeOf(size) == 0)) {
+            return fail(error, end, "Expected 4, 9, 16 or 25 rows of as many cells, got " +
+                std::to_string(numRows) + " rows of " + std::to_string(size));
+        }
+        return validate(board, [size](size_t i, size_t j) { return positions[i * size + j]; }, error);
+    }
+
+private:
+    bool readRow(std::vector<char>& row, std::vector<size_t>& positions)
+    {
+        if (!take('[')) {
+            return expected("'['");
+        }
+        skipSpaces();
+        if (take(']')) {
+            return true;
+        }
+        do {
+            skipSpaces();
+            positions.push_back(position);
+            char cell = 0;
+            if (!readCell(cell)) {
+                return false;
+            }
+            row.push_back(cell);
+            skipSpaces();
+        } while (take(','));
+        return take(']') || expected("',' or ']'");
+    }
+
+    /** A string of a single character or a single digit. */
+    bool readCell(char& cell)
+    {
+        if (position == text.size()) {
+            return expected("a cell");
+        }
+        const auto quote = text[position];
+        if ((quote == '"') || (quote == '\'')) {
+            ++position;
+            if ((position == text.size()) || (text[position] == quote)) {
+                return expected("a character");
+            }
+            cell = text[position++];
+            return take(quote) || expected("a single character between quotes");
+        }
+        if ((quote >= '0') && (quote <= '9')) {
+            cell = text[position++];
+            return (position == text.size()) || (text[position] < '0') || (text[position] > '9') ||
+                expected("a single digit");
+        }
+        return unexpected(error, position, quote);
+    }
+
+    void skipSpaces()
+    {
+        while ((position < text.size()) && ((text[position] == ' ') || (text[position] == '\t') ||
+            (text[position] == '\r') || (text[position] == '\n'))) {
+            ++position;
+        }
+    }
+
+    bool take(char ch)
+    {
+        if ((position < text.size()) && (text[position] == ch)) {
+            ++position;
+            return true;
+        }
+        return false;
+    }
+
+    bool expected(const std::string& what)
+    {
+        if (position == text.size()) {
+            return fail(error, position, "Expected " + what + ", got the end of the input");
+        }
+        return fail(error, position, "Expected " + what + ", got '" + text[position] + "'");
+    }
+
+    std::string_view text;
+    size_t position = 0;
+    Error& error;
+};
+
+}  // namespace
+
+
+bool isLineFormat(std::string_view line)
+{
+    return (line.size() == numElements) && (line.front() != '[');
+}
+
+bool parseLine(std::string_view line, types::state_t& state, Error& error)
+{
+    if (line.size() != numElements) {
+        return fail(error, line.size(), "Expected 81 characters, got " + std::to_string(line.size()));
+    }
+
+    size_t checked = 0;
+    while ((checked + sizeof(chars_t) <= numElements) && areCells(line.data() + checked)) {
+        checked += sizeof(chars_t);
+    }
+    // the rest of the line, and the block with a wrong character if any
+    for (; checked < numElements; ++checked) {
+        if (cellMasks[static_cast<unsigned char>(line[checked])] == 0) {
+            return unexpected(error, checked, line[checked]);
+        }
+    }
+
+    std::array<mask_t, constants::numRows> rows{};
+    auto columns = rows;
+    auto boxes = rows;
+    state.remaining = 0;
+    for (size_t i = 0; i < numElements; ++i) {
+        const auto mask = cellMasks[static_cast<unsigned char>(line[i])];
+        const auto row = i / numColumns;
+        const auto column = i % numColumns;
+        state.cells[row][column] = cell_t(mask);
+        if (mask == allValues) {
+            ++state.remaining;
+            continue;
+        }
+
+        const auto box = (row / boxSize) * boxSize + column / boxSize;
+        if (((rows[row] | columns[column] | boxes[box]) & mask) != 0) {
+            if ((rows[row] & mask) != 0) {
+                return repeated(error, i, line[i], "row", row);
+            }
+            if ((columns[column] & mask) != 0) {
+                return repeated(error, i, line[i], "column", column);
+            }
+            return repeated(error, i, line[i], "box", box);
+        }
+        rows[row] |= mask;
+        columns[column] |= mask;
+        boxes[box] |= mask;
+    }
+    return true;
+}
+
+bool parseBoard(std::string_view text, types::board_t& board, Error& error)
+{
+    if (text.find('[') != std::string_view::npos) {
+        return ArrayReader(text, error).read(board);
+    }
+
+    size_t offset = 0;
+    while ((offset < text.size()) && std::isspace(static_cast<unsigned char>(text[offset]))) {
+        ++offset;
+    }
+    auto cells = text.substr(offset);
+    while (!cells.empty() && std::isspace(static_cast<unsigned char>(cells.back()))) {
+        cells.remove_suffix(1);
+    }
+    return parseCells(cells, offset, board, error);
+}
+
+void boardToState(const types::board_t& board, types::state_t& state)
+{
+    state.remaining = 0;
+    for (size_t i = 0; i < constants::numRows; ++i) {
+        for (size_t j = 0; j < constants::numColumns; ++j) {
+            auto& cell = state.cells[i][j];
+            cell.clear();
+            if (board[i][j] == '.') {
+                for (auto value = '1'; value <= constants::maxValue; ++value) {
+                    cell.emplace(value);
+                }
+                ++state.remaining;
+            } else {
+                cell.emplace(board[i][j]);
+            }
+        }
+    }
+}
+
+}  // namespace parser
+
+}  // namespace sudoku
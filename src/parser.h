@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "types.h"
+
+
+namespace sudoku
+{
+
+/** Reading boards from text, rejecting anything the solver can't take
+ *  before it costs any solver time.
+ *
+ *  Two formats are accepted, with '.' or '0' for an unknown cell and the
+ *  values written as constants::symbols:
+ *
+ *  - a line of all the cells, row by row: 16, 81, 256 or 625 characters;
+ *  - a JSON array of rows, each of them an array of cells, a cell being a
+ *    string of one character or a single digit: [[".","1",...],[...],...]
+ *    (single quotes are accepted as well).
+ *
+ *  Besides the characters, the givens are checked for a value that repeats
+ *  in a row, a column or a box. */
+namespace parser
+{
+
+/** Why a text isn't a board. */
+struct Error
+{
+    /// the offset of the offending character, the size of the text if it
+    /// ended early; for repeated values, the offset of the later given
+    size_t position = 0;
+    std::string message;
+};
+
+/** Whether `line` is a 9x9 board in the format of 81 characters, the one
+ *  parseLine() takes. */
+bool isLineFormat(std::string_view line);
+
+/** Parse a 9x9 board of 81 characters straight into a solver state.
+ *
+ *  The fast path of Batch: the characters are checked 16 at a time, then
+ *  the cells are converted by a table lookup, checking the givens on the
+ *  way. On failure `state` is left in an unspecified state. */
+bool parseLine(std::string_view line, types::state_t& state, Error& error);
+
+/** Parse a board of any size and format into `board`, '0' is turned
+ *  into '.'. The capacity of `board` is reused, so parsing many boards
+ *  into the same one doesn't allocate. */
+bool parseBoard(std::string_view text, types::board_t& board, Error& error);
+
+/** Convert a 9x9 board of parseBoard() into a solver state. */
+void boardToState(const types::board_t& board, types::state_t& state);
+
+}  // namespace parser
+
+}  // namespace sudoku
@@ -0,0 +1,604 @@
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "constants.h"
+#include "display.h"
+#include "input.h"
+#include "parser.h"
+#include "server.h"
+#include "solution_cache.h"
+#include "thread_pool.h"
+
+
+namespace sudoku
+{
+
+struct Server::Private
+{
+    // bytes read from a connection at once
+    static const size_t readSize = 64 * 1024;
+
+    /** The fields of a request, pointing into its line. */
+    struct Request
+    {
+        // the JSON string or number as it appears in the request
+        std::string_view id = "null";
+        std::string_view board;
+        // the contents of the string of a "command"
+        std::string_view command;
+        // the board is the contents of a JSON string rather than an array
+        bool boardIsString = false;
+    };
+
+    /** Everything needed to answer a request, reused from request to request. */
+    struct Worker
+    {
+        Worker(const Options& options, SolutionCache* cache): solver(options.engine), cache(cache),
+            timeout(options.timeout), maxBranches(options.maxBranches)
+        {
+            solver.setTechniques(options.techniques);
+        }
+
+        Solver solver;
+        SolutionCache* cache;
+        std::chrono::milliseconds timeout;
+        std::uint64_t maxBranches;
+        Solver::board_t board;
+        types::state_t state;
+        parser::Error error;
+        std::string response;
+    };
+
+    /** Both ends of a client: stdin and stdout, or a socket. */
+    struct Connection
+    {
+        Connection(int input, int output, bool ownsDescriptor): input(input), output(output),
+            ownsDescriptor(ownsDescriptor)
+        {}
+
+        ~Connection()
+        {
+            if (ownsDescriptor) {
+                ::close(input);
+            }
+        }
+
+        Connection(const Connection&) = delete;
+        Connection& operator=(const Connection&) = delete;
+
+        int input;
+        int output;
+        bool ownsDescriptor;
+        // responses of several threads of the pool must not interleave
+        std::mutex writeMutex;
+        // cleared when the client went away, later responses are dropped
+        bool open = true;
+    };
+
+    static void skipSpaces(std::string_view& text)
+    {
+        while (!text.empty() && ((text.front() == ' ') || (text.front() == '\t') || (text.front() == '\r'))) {
+            text.remove_prefix(1);
+        }
+    }
+
+    /** Remove a JSON string from the front of `text`, `contents` is set to
+     *  the characters between the quotes, escapes included. */
+    static bool takeString(std::string_view& text, std::string_view& contents)
+    {
+        if (text.empty() || (text.front() != '"')) {
+            return false;
+        }
+        for (size_t i = 1; i < text.size(); ++i) {
+            if (text[i] == '\\') {
+                ++i;
+            } else if (text[i] == '"') {
+                contents = text.substr(1, i - 1);
+                text.remove_prefix(i + 1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /** Remove any JSON value from the front of `text` and return it as it is. */
+    static bool takeValue(std::string_view& text, std::string_view& value)
+    {
+        const auto start = text;
+        std::string_view contents;
+        if (!text.empty() && (text.front() == '"')) {
+            if (!takeString(text, contents)) {
+                return false;
+            }
+        } else if (!text.empty() && ((text.front() == '[') || (text.front() == '{'))) {
+            size_t depth = 0;
+            do {
+                if (text.empty()) {
+                    return false;
+                }
+                if (text.front() == '"') {
+                    if (!takeString(text, contents)) {
+                        return false;
+                    }
+                    continue;
+                }
+                if ((text.front() == '[') || (text.front() == '{')) {
+                    ++depth;
+                } else if ((text.front() == ']') || (text.front() == '}')) {
+                    --depth;
+                }
+                text.remove_prefix(1);
+            } while (depth != 0);
+        } else {
+            // a number, true, false or null
+            while (!text.empty() && (std::strchr(" \t\r,}]", text.front()) == nullptr)) {
+                text.remove_prefix(1);
+            }
+        }
+        value = start.substr(0, start.size() - text.size());
+        return !value.empty();
+    }
+
+    /** Whether `text` is a JSON number: -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)? */
+    static bool isNumber(std::string_view text)
+    {
+        const auto takeDigits = [&text]() {
+            size_t numDigits = 0;
+            while (!text.empty() && (text.front() >= '0') && (text.front() <= '9')) {
+                text.remove_prefix(1);
+                ++numDigits;
+            }
+            return numDigits;
+        };
+
+        if (!text.empty() && (text.front() == '-')) {
+            text.remove_prefix(1);
+        }
+        const auto leadingZero = !text.empty() && (text.front() == '0');
+        const auto numDigits = takeDigits();
+        if ((numDigits == 0) || (leadingZero && (numDigits > 1))) {
+            return false;
+        }
+        if (!text.empty() && (text.front() == '.')) {
+            text.remove_prefix(1);
+            if (takeDigits() == 0) {
+                return false;
+            }
+        }
+        if (!text.empty() && ((text.front() == 'e') || (text.front() == 'E'))) {
+            text.remove_prefix(1);
+            if (!text.empty() && ((text.front() == '+') || (text.front() == '-'))) {
+                text.remove_prefix(1);
+            }
+            if (takeDigits() == 0) {
+                return false;
+            }
+        }
+        return text.empty();
+    }
+
+    /** Pick the "id" and the "board" or the "command" out of a JSON object,
+     *  other keys are ignored. The id must be a string or a number. */
+    static bool parseRequest(std::string_view line, Request& request)
+    {
+        skipSpaces(line);
+        if (line.empty() || (line.front() != '{')) {
+            return false;
+        }
+        line.remove_prefix(1);
+        skipSpaces(line);
+        if (!line.empty() && (line.front() == '}')) {
+            return false;
+        }
+
+        for (;;) {
+            std::string_view key;
+            std::string_view value;
+            skipSpaces(line);
+            if (!takeString(line, key)) {
+                return false;
+            }
+            skipSpaces(line);
+            if (line.empty() || (line.front() != ':')) {
+                return false;
+            }
+            line.remove_prefix(1);
+            skipSpaces(line);
+            if (!takeValue(line, value)) {
+                return false;
+            }
+
+            if (key == "id") {
+                if ((value.front() != '"') && !isNumber(value)) {
+                    return false;
+                }
+                request.id = value;
+            } else if (key == "board") {
+                request.boardIsString = (value.front() == '"');
+                request.board = request.boardIsString ? value.substr(1, value.size() - 2) : value;
+            } else if ((key == "command") && (value.front() == '"')) {
+                request.command = value.substr(1, value.size() - 2);
+            }
+
+            skipSpaces(line);
+            if (line.empty()) {
+                return false;
+            }
+            const auto separator = line.front();
+            line.remove_prefix(1);
+            if (separator == '}') {
+                break;
+            }
+            if (separator != ',') {
+                return false;
+            }
+        }
+        return !request.board.empty() || !request.command.empty();
+    }
+
+    /** Parse the board of a request into `worker.state`, straight from the
+     *  text for the format of 81 characters, like Batch. */
+    static bool parseBoard(Worker& worker, const Request& request)
+    {
+        if (request.boardIsString && parser::isLineFormat(request.board)) {
+            return parser::parseLine(request.board, worker.state, worker.error);
+        }
+        if (!parser::parseBoard(request.board, worker.board, worker.error)) {
+            return false;
+        }
+        if (worker.board.size() != constants::numRows) {
+            worker.error = {0, "Expected a 9x9 board"};
+            return false;
+        }
+        parser::boardToState(worker.board, worker.state);
+        return true;
+    }
+
+    /** Append `text` to `output` as the contents of a JSON string. */
+    static void appendEscaped(std::string& output, std::string_view text)
+    {
+        for (const auto ch: text) {
+            if ((ch == '"') || (ch == '\\')) {
+                output += '\\';
+                output += ch;
+            } else if (static_cast<unsigned char>(ch) < 0x20) {
+                output += ' ';
+            } else {
+                output += ch;
+            }
+        }
+    }
+
+    /** Append the id of a request to `output`. A number is copied, a string
+     *  keeps its valid escapes, but anything else that would break the JSON
+     *  of the response is escaped like appendEscaped() does. */
+    static void appendId(std::string& output, std::string_view id)
+    {
+        if (id.front() != '"') {
+            output += id;
+            return;
+        }
+
+        const auto contents = id.substr(1, id.size() - 2);
+        output += '"';
+        for (size_t i = 0; i < contents.size(); ++i) {
+            const auto escape = contents.substr(i, 6);
+            const auto isHex = [](char ch) { return std::isxdigit(static_cast<unsigned char>(ch)) != 0; };
+            if ((escape.size() >= 2) && (escape[0] == '\\') &&
+                (std::string_view("\"\\/bfnrt").find(escape[1]) != std::string_view::npos)) {
+                output += escape.substr(0, 2);
+                ++i;
+            } else if ((escape.size() == 6) && escape.starts_with("\\u") &&
+                std::all_of(escape.begin() + 2, escape.end(), isHex)) {
+                output += escape;
+                i += 5;
+            } else {
+                appendEscaped(output, escape.substr(0, 1));
+            }
+        }
+        output += '"';
+    }
+
+    /** Append the response to the request on `line` to `worker.response`. */
+    static void answer(Worker& worker, std::string_view line)
+    {
+        auto& response = worker.response;
+        Request request;
+        const auto parsed = parseRequest(line, request);
+        response += "{\"id\":";
+        appendId(response, request.id);
+        if (!parsed) {
+            response += ",\"status\":\"invalid\",\"error\":\"Expected a JSON object with a board\"}\n";
+            return;
+        }
+        if (request.board.empty()) {
+            answerCommand(worker, request.command);
+            return;
+        }
+        if (!parseBoard(worker, request)) {
+            response += ",\"status\":\"invalid\",\"error\":\"";
+            appendEscaped(response, worker.error.message);
+            response += "\",\"position\":";
+            response += std::to_string(worker.error.position);
+            response += "}\n";
+            return;
+        }
+
+        Solver::Limits limits;
+        if (worker.timeout.count() != 0) {
+            limits.deadline = std::chrono::steady_clock::now() + worker.timeout;
+        }
+        limits.maxBranches = worker.maxBranches;
+
+        const auto start = response.size();
+        response += ",\"status\":\"solved\",\"solution\":\"";
+        auto status = Solver::Status::NoSolution;
+        worker.solver.load(worker.state);
+        if (worker.cache != nullptr) {
+            auto cached = false;
+            status = worker.cache->solve(worker.solver, worker.state, limits, response, cached);
+        } else {
+            status = worker.solver.solve(limits);
+            if (status == Solver::Status::Solved) {
+                worker.solver.appendValues(response);
+            }
+        }
+
+        switch (status) {
+            case Solver::Status::Solved:
+                response += "\"}\n";
+                break;
+            case Solver::Status::NoSolution:
+                response.resize(start);
+                response += ",\"status\":\"unsolvable\"}\n";
+                break;
+            case Solver::Status::TimedOut:
+            case Solver::Status::OutOfBudget:
+                response.resize(start);
+                response += ",\"status\":\"";
+                response += (status == Solver::Status::TimedOut) ? "timeout" : "budget";
+                response += "\",\"state\":\"";
+                worker.solver.appendValues(response);
+                response += "\"}\n";
+                break;
+        }
+    }
+
+    /** Append the rest of the response to a request with a command. */
+    static void answerCommand(Worker& worker, std::string_view command)
+    {
+        auto& response = worker.response;
+        if (command != "stats") {
+            response += ",\"status\":\"invalid\",\"error\":\"Unknown command\"}\n";
+            return;
+        }
+
+        const auto stats = (worker.cache != nullptr) ? worker.cache->stats() : SolutionCache::Stats();
+        response += ",\"status\":\"stats\",\"lookups\":";
+        response += std::to_string(stats.lookups);
+        response += ",\"hits\":";
+        response += std::to_string(stats.hits);
+        response += ",\"entries\":";
+        response += std::to_string(stats.entries);
+        response += ",\"capacity\":";
+        response += std::to_string(stats.capacity);
+        response += ",\"bytes\":";
+        response += std::to_string(stats.bytes);
+        response += "}\n";
+    }
+
+    /** Write all of `text`, returns false if the client went away. */
+    static bool writeAll(int fd, std::string_view text)
+    {
+        while (!text.empty()) {
+            const auto written = ::write(fd, text.data(), text.size());
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            text.remove_prefix(static_cast<size_t>(written));
+        }
+        return true;
+    }
+
+    static void send(Connection& connection, std::string_view response)
+    {
+        std::lock_guard lock(connection.writeMutex);
+        if (connection.open && !writeAll(connection.output, response)) {
+            connection.open = false;
+        }
+    }
+
+    /** Read requests from `connection` until its end and answer each of them.
+     *
+     *  Without a pool the requests are answered by `worker`, and the responses
+     *  to all the requests of a single read are written at once. With a pool
+     *  every request is a task, which keeps the connection alive until its
+     *  response is written. */
+    static void serve(std::shared_ptr<Connection> connection, Worker* worker, ThreadPool* pool,
+        std::vector<Worker>* workers)
+    {
+        std::string buffer;
+        std::string chunk(readSize, '\0');
+        auto handle = [&](std::string_view line) {
+            if (line.empty()) {
+                return;
+            }
+            if (pool == nullptr) {
+                answer(*worker, line);
+                return;
+            }
+            pool->submit([connection, workers, line = std::string(line)](size_t workerIndex) {
+                auto& worker = (*workers)[workerIndex];
+                worker.response.clear();
+                answer(worker, line);
+                send(*connection, worker.response);
+            });
+        };
+
+        for (;;) {
+            const auto numRead = ::read(connection->input, chunk.data(), chunk.size());
+            if (numRead < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            if (numRead == 0) {
+                break;
+            }
+            buffer.append(chunk.data(), static_cast<size_t>(numRead));
+
+            if (worker != nullptr) {
+                worker->response.clear();
+            }
+            std::string_view text = buffer;
+            while (text.find('\n') != std::string_view::npos) {
+                handle(input::nextLine(text));
+            }
+            buffer.erase(0, buffer.size() - text.size());
+            if ((worker != nullptr) && !worker->response.empty()) {
+                send(*connection, worker->response);
+            }
+            if (!connection->open) {
+                return;
+            }
+        }
+
+        // a last request without a line break
+        std::string_view text = buffer;
+        if (worker != nullptr) {
+            worker->response.clear();
+        }
+        handle(input::nextLine(text));
+        if ((worker != nullptr) && !worker->response.empty()) {
+            send(*connection, worker->response);
+        }
+    }
+
+    static int serveStandardStreams(Server& self)
+    {
+        auto connection = std::make_shared<Connection>(STDIN_FILENO, STDOUT_FILENO, false);
+        if (self.options.numThreads == 1) {
+            Worker worker(self.options, self.cache.get());
+            serve(connection, &worker, nullptr, nullptr);
+        } else {
+            ThreadPool pool(self.options.numThreads);
+            std::vector<Worker> workers(pool.size(), Worker(self.options, self.cache.get()));
+            serve(connection, nullptr, &pool, &workers);
+            pool.wait();
+        }
+
+        if (self.cache) {
+            display::printCacheStats(self.cache->stats(), std::cerr);
+        }
+        return 0;
+    }
+
+    static int listen(const std::string& path)
+    {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) {
+            throw std::system_error(ENAMETOOLONG, std::generic_category(), "Can't listen on " + path);
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+        const auto fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "Can't create a socket");
+        }
+        // a socket left behind by a previous server, but nothing else
+        struct stat status;
+        if ((::lstat(path.c_str(), &status) == 0) && S_ISSOCK(status.st_mode)) {
+            ::unlink(path.c_str());
+        }
+        if ((::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) ||
+            (::listen(fd, SOMAXCONN) != 0)) {
+            const auto error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "Can't listen on " + path);
+        }
+        return fd;
+    }
+
+    static int serveSocket(Server& self)
+    {
+        const auto listener = listen(self.options.socketPath);
+
+        std::unique_ptr<ThreadPool> pool;
+        std::vector<Worker> workers;
+        if (self.options.numThreads != 1) {
+            pool = std::make_unique<ThreadPool>(self.options.numThreads);
+            workers.assign(pool->size(), Worker(self.options, self.cache.get()));
+        }
+
+        for (;;) {
+            const auto fd = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd < 0) {
+                if ((errno == EINTR) || (errno == ECONNABORTED)) {
+                    continue;
+                }
+                const auto error = errno;
+                ::close(listener);
+                throw std::system_error(error, std::generic_category(), "Can't accept a connection");
+            }
+
+            auto connection = std::make_shared<Connection>(fd, fd, true);
+            // every connection has a thread reading its requests
+            std::thread([&self, connection, pool = pool.get(), &workers]() {
+                if (pool == nullptr) {
+                    Worker worker(self.options, self.cache.get());
+                    serve(connection, &worker, nullptr, nullptr);
+                } else {
+                    serve(connection, nullptr, pool, &workers);
+                }
+            }).detach();
+        }
+    }
+};
+
+
+Server::Server(const Options& options)
+    : options(options)
+{}
+
+Server::~Server()
+{}
+
+int Server::run()
+{
+    // a client that goes away must not kill the server
+    std::signal(SIGPIPE, SIG_IGN);
+
+    if (options.cacheSize != 0) {
+        cache = std::make_unique<SolutionCache>(options.cacheSize);
+    }
+
+    if (options.socketPath.empty()) {
+        return Private::serveStandardStreams(*this);
+    }
+    return Private::serveSocket(*this);
+}
+
+}  // namespace sudoku
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "interface.h"
+#include "solver.h"
+
+
+namespace sudoku
+{
+
+class SolutionCache;
+
+/** A long-lived solver that answers requests of JSON lines, either on stdin
+ *  and stdout or on each connection to a Unix domain socket.
+ *
+ *  A request is a JSON object with an "id" (a string or a number, echoed back)
+ *  and a 9x9 "board" in one of the formats of parser::parseBoard(),
+ *  either a string or a JSON array:
+ *
+ *      {"id": 7, "board": "8..........36......7..9.2...5...7......."}
+ *
+ *  Each of them gets a single line in return:
+ *
+ *      {"id":7,"status":"solved","solution":"812753649943682175..."}
+ *      {"id":7,"status":"unsolvable"}
+ *      {"id":7,"status":"invalid","error":"...","position":12}
+ *
+ *  The position of an invalid board is the offset of the error in the
+ *  board, as in parser::Error.
+ *
+ *  With a timeout or a budget of branches, a search cut short answers
+ *  with the board as far as the propagation of the givens got, see
+ *  Solver::solve(const Limits&):
+ *
+ *      {"id":7,"status":"timeout","state":"8.2753649943682175..."}
+ *      {"id":7,"status":"budget","state":"8.2753649943682175..."}
+ *
+ *  With a cache, boards equivalent to one solved before are answered from
+ *  a SolutionCache shared by all the connections. Its counters are the
+ *  response to a request with a "command" of "stats" instead of a board,
+ *  and they are printed to stderr at the end of stdin:
+ *
+ *      {"id":8,"command":"stats"}
+ *      {"id":8,"status":"stats","lookups":120,"hits":75,"entries":45,"capacity":100000,"bytes":17920}
+ *
+ *  Requests can be pipelined. With a single thread the requests of a
+ *  connection are answered in order, by a Solver of the connection. With
+ *  more threads they are dispatched to the Solvers of a ThreadPool and the
+ *  responses are written as soon as they are ready, so their order may
+ *  differ from that of the requests. */
+class Server: public Interface
+{
+public:
+    struct Options
+    {
+        Solver::Engine engine = Solver::Engine::Propagation;
+        Solver::Techniques techniques;
+        /// zero means one per hardware thread
+        size_t numThreads = 1;
+        /// the path of the Unix domain socket to listen on, stdin and stdout if empty
+        std::string socketPath;
+        /// the time a request may take, no limit if zero
+        std::chrono::milliseconds timeout{0};
+        /// the branches of the search of a request, no limit if zero
+        std::uint64_t maxBranches = 0;
+        /// the number of boards of the SolutionCache, none if zero
+        size_t cacheSize = 0;
+    };
+
+    explicit Server(const Options& options);
+    ~Server();
+
+    /** Serve stdin until its end, or the socket until the process is killed.
+     *
+     *  A socket left at the path by a previous server is replaced, any other
+     *  file is not. Throws std::system_error if the socket can't be set up. */
+    int run() override;
+
+private:
+    Options options;
+    std::unique_ptr<SolutionCache> cache;
+    struct Private;
+};
+
+}  // namespace sudoku
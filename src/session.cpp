@@ -0,0 +1,124 @@
+#include "session.h"
+
+
+namespace sudoku
+{
+
+template<size_t BoxSize>
+BasicSession<BoxSize>::BasicSession(const board_t& board)
+{
+    solver.load(board);
+    for (size_t row = 0; row < board.size(); ++row) {
+        for (size_t column = 0; column < board[row].size(); ++column) {
+            isGiven[row * grid::numColumns + column] = (board[row][column] != '.');
+        }
+    }
+    givensFit = solver.propagate();
+    placements.reserve(grid::numElements);
+}
+
+template<size_t BoxSize>
+bool BasicSession<BoxSize>::place(size_t row, size_t column, char value)
+{
+    if ((row >= grid::numRows) || (column >= grid::numColumns) || !grid::isSymbol(value)) {
+        return false;
+    }
+    const auto index = row * grid::numColumns + column;
+    if (isGiven[index]) {
+        return false;
+    }
+
+    const auto position = find(index);
+    if (position != placements.size()) {
+        if (placements[position].value == value) {
+            return true;
+        }
+        erase(position);
+    }
+    placements.push_back({index, value, true, {}});
+    apply(placements.back());
+    return true;
+}
+
+template<size_t BoxSize>
+bool BasicSession<BoxSize>::clear(size_t row, size_t column)
+{
+    if ((row >= grid::numRows) || (column >= grid::numColumns)) {
+        return false;
+    }
+    const auto position = find(row * grid::numColumns + column);
+    if (position == placements.size()) {
+        return false;
+    }
+    erase(position);
+    return true;
+}
+
+template<size_t BoxSize>
+const typename BasicSession<BoxSize>::cell_t& BasicSession<BoxSize>::candidates(size_t row, size_t column) const
+{
+    return solver.candidates(row * grid::numColumns + column);
+}
+
+template<size_t BoxSize>
+bool BasicSession<BoxSize>::isConsistent() const
+{
+    return givensFit && (numConflicts == 0);
+}
+
+template<size_t BoxSize>
+bool BasicSession<BoxSize>::solve(char* values)
+{
+    return isConsistent() && solver.findSolution(values);
+}
+
+template<size_t BoxSize>
+void BasicSession<BoxSize>::apply(Placement& placement)
+{
+    placement.before = solver.checkpoint();
+    placement.fits = givensFit && solver.assume(placement.index, placement.value);
+    if (!placement.fits) {
+        solver.rollback(placement.before);
+        ++numConflicts;
+    }
+}
+
+/** Place the values from position `first` on again, the state being the
+ *  one before the value that was at `first` earlier. */
+template<size_t BoxSize>
+void BasicSession<BoxSize>::replay(size_t first)
+{
+    for (auto position = first; position < placements.size(); ++position) {
+        apply(placements[position]);
+    }
+}
+
+/** The position of the value placed at `index`, or the number of values
+ *  placed if there is none. */
+template<size_t BoxSize>
+size_t BasicSession<BoxSize>::find(size_t index) const
+{
+    size_t position = 0;
+    while ((position < placements.size()) && (placements[position].index != index)) {
+        ++position;
+    }
+    return position;
+}
+
+template<size_t BoxSize>
+void BasicSession<BoxSize>::erase(size_t position)
+{
+    solver.rollback(placements[position].before);
+    for (auto other = position; other < placements.size(); ++other) {
+        numConflicts -= !placements[other].fits;
+    }
+    placements.erase(placements.begin() + position);
+    replay(position);
+}
+
+template class BasicSession<2>;
+template class BasicSession<3>;
+template class BasicSession<4>;
+template class BasicSession<5>;
+
+}  // namespace sudoku
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "constants.h"
+#include "solver.h"
+#include "types.h"
+
+
+namespace sudoku
+{
+
+/** A board edited one cell at a time, e.g. by an interactive front end,
+ *  which keeps the potential values of every cell up to date as it goes.
+ *
+ *  Placing a value propagates it from the state of the previous edit, so
+ *  an edit costs the eliminations it causes rather than a load() of the
+ *  whole board. Before every placement the session takes a checkpoint of
+ *  its solver; clearing a value rolls back to the checkpoint of its
+ *  placement and places the later values again, which is a single
+ *  rollback for the value placed last.
+ *
+ *  A value that contradicts the givens and the values placed before it is
+ *  kept, but not propagated: it makes the board inconsistent until it, or
+ *  one of the values it contradicts, is cleared. */
+template<size_t BoxSize>
+class BasicSession
+{
+    using grid = constants::Grid<BoxSize>;
+
+public:
+    using board_t = types::board_t;
+    using cell_t = types::basic_cell_t<BoxSize>;
+
+    /** A session editing the unknown cells of `board`, '.' in a board of
+     *  CommandLine::parseBoard(); its other cells are the givens. */
+    explicit BasicSession(const board_t& board);
+
+    /** Place `value` in an unknown cell, replacing the value placed there
+     *  before. Returns false, changing nothing, if the cell is a given or
+     *  `value` is not a symbol of the grid. */
+    bool place(size_t row, size_t column, char value);
+
+    /** Clear the value placed in a cell; returns false if there is none. */
+    bool clear(size_t row, size_t column);
+
+    /** The values that fit a cell given the givens and the values placed
+     *  so far, leaving out those that contradict them; the single value of
+     *  a given or placed cell. Only meaningful while the givens themselves
+     *  are consistent. */
+    const cell_t& candidates(size_t row, size_t column) const;
+
+    /** Whether the givens and the placed values have no contradiction the
+     *  propagation can see; solve() tells whether they have a solution. */
+    bool isConsistent() const;
+
+    /** Write a solution of the board with the placed values to the
+     *  grid::numElements characters at `values`, row by row, without
+     *  changing the session. Returns false if there is none. */
+    bool solve(char* values);
+
+private:
+    using Solver = BasicSolver<BoxSize>;
+
+    struct Placement
+    {
+        size_t index;
+        char value;
+        /// false if the value contradicted the ones before it and isn't propagated
+        bool fits;
+        /// the state before the value was placed
+        typename Solver::Checkpoint before;
+    };
+
+    void apply(Placement& placement);
+    void replay(size_t first);
+    size_t find(size_t index) const;
+    void erase(size_t position);
+
+    Solver solver;
+    std::array<bool, grid::numElements> isGiven = {};
+    bool givensFit = true;
+    // in the order they were placed
+    std::vector<Placement> placements;
+    size_t numConflicts = 0;
+};
+
+using Session = BasicSession<constants::boxSize>;
+
+}  // namespace sudoku
@@ -0,0 +1,112 @@
+#include <algorithm>
+
+#include "solution_cache.h"
+
+
+namespace sudoku
+{
+
+SolutionCache::SolutionCache(size_t capacity)
+    : capacity(capacity)
+{
+    index.reserve(capacity);
+}
+
+std::string_view SolutionCache::keyOf(const canonical::values_t& key)
+{
+    return std::string_view(key.data(), key.size());
+}
+
+bool SolutionCache::find(const canonical::values_t& key, bool& solved, canonical::values_t& solution)
+{
+    std::lock_guard lock(mutex);
+    ++lookups;
+    const auto found = index.find(keyOf(key));
+    if (found == index.end()) {
+        return false;
+    }
+
+    ++hits;
+    const auto entry = found->second;
+    entries.splice(entries.begin(), entries, entry);
+    solved = entry->solved;
+    if (solved) {
+        solution = entry->solution;
+    }
+    return true;
+}
+
+void SolutionCache::insert(const canonical::values_t& key, bool solved, const canonical::values_t& solution)
+{
+    if (capacity == 0) {
+        return;
+    }
+
+    std::lock_guard lock(mutex);
+    if (index.find(keyOf(key)) != index.end()) {
+        // another thread solved the same board in the meantime
+        return;
+    }
+
+    if (entries.size() == capacity) {
+        // reuse the least recently used entry
+        index.erase(keyOf(entries.back().key));
+        entries.splice(entries.begin(), entries, std::prev(entries.end()));
+        entries.front() = Entry{key, solution, solved};
+    } else {
+        entries.push_front(Entry{key, solution, solved});
+    }
+    index.emplace(keyOf(entries.front().key), entries.begin());
+}
+
+Solver::Status SolutionCache::solve(Solver& solver, const types::state_t& state, const Solver::Limits& limits,
+    std::string& output, bool& cached)
+{
+    canonical::values_t key;
+    canonical::Transform transform;
+    canonical::values_t canonicalSolution{};
+    canonical::values_t solution;
+    const auto canonicalized = canonical::canonicalize(state, key, transform);
+    auto solved = false;
+    cached = canonicalized && find(key, solved, canonicalSolution);
+    if (cached) {
+        if (!solved) {
+            return Solver::Status::NoSolution;
+        }
+        transform.fromCanonical(canonicalSolution, solution);
+        output.append(solution.data(), solution.size());
+        return Solver::Status::Solved;
+    }
+
+    const auto status = solver.solve(limits);
+    solved = (status == Solver::Status::Solved);
+    if (solved) {
+        const auto start = output.size();
+        solver.appendValues(output);
+        std::copy_n(output.data() + start, solution.size(), solution.begin());
+    }
+    if (canonicalized && (solved || (status == Solver::Status::NoSolution))) {
+        if (solved) {
+            transform.toCanonical(solution, canonicalSolution);
+        }
+        insert(key, solved, canonicalSolution);
+    }
+    return status;
+}
+
+SolutionCache::Stats SolutionCache::stats() const
+{
+    std::lock_guard lock(mutex);
+    Stats stats;
+    stats.lookups = lookups;
+    stats.hits = hits;
+    stats.entries = entries.size();
+    stats.capacity = capacity;
+    // a list node has two links, a node of the index a link and the hash
+    const auto entryBytes = sizeof(Entry) + 2 * sizeof(void*);
+    const auto indexBytes = sizeof(index_t::value_type) + sizeof(void*) + sizeof(size_t);
+    stats.bytes = entries.size() * (entryBytes + indexBytes) + index.bucket_count() * sizeof(void*);
+    return stats;
+}
+
+}  // namespace sudoku
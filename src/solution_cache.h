@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "canonical.h"
+#include "solver.h"
+
+
+namespace sudoku
+{
+
+/** A bounded cache of the solutions of 9x9 boards, keyed by their canonical
+ *  form, so a board that is a relabelled, shuffled or transposed copy of an
+ *  earlier one costs a lookup instead of a search.
+ *
+ *  Boards without a solution are remembered as well. The least recently
+ *  used entry makes room for a new one once the cache is full. Every
+ *  method can be called from any thread. */
+class SolutionCache
+{
+public:
+    struct Stats
+    {
+        std::uint64_t lookups = 0;
+        std::uint64_t hits = 0;
+        size_t entries = 0;
+        size_t capacity = 0;
+        /// an estimate of the memory of the entries and the index
+        size_t bytes = 0;
+    };
+
+    /** A cache of at most `capacity` boards. */
+    explicit SolutionCache(size_t capacity);
+
+    SolutionCache(const SolutionCache&) = delete;
+    SolutionCache& operator=(const SolutionCache&) = delete;
+
+    /** Look up the canonical form `key`. On a hit, `solved` tells whether the
+     *  board has a solution, and if so `solution` is set to it in the
+     *  canonical form. */
+    bool find(const canonical::values_t& key, bool& solved, canonical::values_t& solution);
+
+    /** Remember the canonical solution of the canonical form `key`, or that
+     *  it has none if `solved` is false. */
+    void insert(const canonical::values_t& key, bool solved, const canonical::values_t& solution);
+
+    /** Solve the board with the givens of `state` with `solver` within
+     *  `limits`, unless the answer for an equivalent board is cached, and
+     *  remember the answer otherwise. `solver` must have loaded `state`, or a
+     *  state propagated from it: the key is computed from the givens alone,
+     *  so that it is the same for every board of a class.
+     *
+     *  A solution is appended to `output` as by Solver::appendValues(),
+     *  a board with several of them may get any one. Searches cut short by
+     *  the limits are not remembered. `cached` tells whether the solver was
+     *  spared, its stats() are those of an earlier board then. */
+    Solver::Status solve(Solver& solver, const types::state_t& state, const Solver::Limits& limits,
+        std::string& output, bool& cached);
+
+    Stats stats() const;
+
+private:
+    struct Entry
+    {
+        canonical::values_t key;
+        canonical::values_t solution;
+        bool solved;
+    };
+    using entries_t = std::list<Entry>;
+
+    // the keys point into the entries, which never move
+    using index_t = std::unordered_map<std::string_view, entries_t::iterator>;
+
+    static std::string_view keyOf(const canonical::values_t& key);
+
+    size_t capacity;
+    mutable std::mutex mutex;
+    // the most recently used first
+    entries_t entries;
+    index_t index;
+    std::uint64_t lookups = 0;
+    std::uint64_t hits = 0;
+};
+
+}  // namespace sudoku
@@ -1,340 +1,1088 @@
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <cassert>
-#include <unordered_map>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
 
 #include "constants.h"
 #include "display.h"
+#include "dlx.h"
 #include "solver.h"
+#include "thread_pool.h"
+#include "trace.h"
 #include "utils.h"
 
 
 namespace sudoku
 {
 
-using cell_t = types::cell_t;
-
-Solver::Exception::~Exception() noexcept
+SolverBase::Exception::~Exception() noexcept
 {}
 
-struct Solver::Private
+SolverBase::Stats& SolverBase::Stats::operator+=(const Stats& other)
 {
-    static const auto maxValue = constants::maxValue;
-    static const auto boxSize = constants::boxSize;
-    static const auto numBoxes = constants::numBoxes;
-    static const auto numRows = constants::numRows;
-    static const auto numColumns = constants::numColumns;
-    static const auto numElements = constants::numElements;
+    propagationPasses += other.propagationPasses;
+    peerEliminations += other.peerEliminations;
+    nakedSingles += other.nakedSingles;
+    hiddenSingles += other.hiddenSingles;
+    intersectionEliminations += other.intersectionEliminations;
+    nakedSubsetEliminations += other.nakedSubsetEliminations;
+    hiddenSubsetEliminations += other.hiddenSubsetEliminations;
+    xWingEliminations += other.xWingEliminations;
+    branchesCreated += other.branchesCreated;
+    branchesTried += other.branchesTried;
+    backtracks += other.backtracks;
+    maxDepth = std::max(maxDepth, other.maxDepth);
+    propagationSeconds += other.propagationSeconds;
+    searchSeconds += other.searchSeconds;
+    return *this;
+}
+
+template<size_t BoxSize, typename TraceSink>
+struct BasicSolver<BoxSize, TraceSink>::Private
+{
+    using Self = BasicSolver<BoxSize, TraceSink>;
+
+    static const auto boxSize = grid::boxSize;
+    static const auto numBoxes = grid::numBoxes;
+    static const auto numRows = grid::numRows;
+    static const auto numColumns = grid::numColumns;
+    static const auto numValues = grid::numValues;
+    static const auto numElements = grid::numElements;
 
-    static void eraseState(Solver& self)
+    static void eraseState(Self& self)
     {
         self.state.erase();
-        self.forkStates.reset();
+        self.trailSize = 0;
+        self.worklistSize = 0;
+        self.unitsToUpdate = unitSet_t();
     }
 
-    static percent_t unknownPercent(const Solver& self)
+    static percent_t unknownPercent(const Self& self)
     {
         return static_cast<percent_t>(self.state.remaining) / numElements * 100.0;
     }
 
-    static void createState(Solver& self, const board_t& board)
+    static const auto numPeers = (numRows - 1) + (numColumns - 1) + (boxSize - 1) * (boxSize - 1);
+
+    using peers_t = std::array<std::array<index_t, numPeers>, numElements>;
+
+    /** For every cell the indices of the numPeers other cells in its row,
+     *  column and box, 20 of them in a 9x9 grid: a value fixed in a cell
+     *  must be erased from all of them. */
+    static constexpr peers_t createPeers()
+    {
+        peers_t peers{};
+        for (size_t cell = 0; cell < numElements; ++cell) {
+            const auto row = cell / numColumns;
+            const auto column = cell % numColumns;
+            size_t numFound = 0;
+            for (size_t other = 0; other < numElements; ++other) {
+                const auto otherRow = other / numColumns;
+                const auto otherColumn = other % numColumns;
+                const auto sameBox = (row / boxSize == otherRow / boxSize) &&
+                    (column / boxSize == otherColumn / boxSize);
+                if ((other != cell) && ((otherRow == row) || (otherColumn == column) || sameBox)) {
+                    peers[cell][numFound++] = static_cast<index_t>(other);
+                }
+            }
+        }
+        return peers;
+    }
+
+    static const peers_t peers;
+
+    using unit_t = std::array<index_t, numValues>;
+    using units_t = std::array<unit_t, numUnits>;
+
+    /** The cells of every row, then of every column, then of every box. */
+    static constexpr units_t createUnits()
+    {
+        units_t units{};
+        for (size_t cell = 0; cell < numElements; ++cell) {
+            const auto row = cell / numColumns;
+            const auto column = cell % numColumns;
+            const auto box = (row / boxSize) * boxSize + column / boxSize;
+            const auto position = (row % boxSize) * boxSize + column % boxSize;
+            units[row][column] = static_cast<index_t>(cell);
+            units[numRows + column][row] = static_cast<index_t>(cell);
+            units[numRows + numColumns + box][position] = static_cast<index_t>(cell);
+        }
+        return units;
+    }
+
+    static const units_t units;
+
+    static const size_t unitWordSize = 8 * sizeof(unitWord_t);
+    using unitsOfCell_t = std::array<unitSet_t, numElements>;
+
+    /** For every cell the set of the row, column and box it belongs to. */
+    static constexpr unitsOfCell_t createUnitsOfCell()
+    {
+        unitsOfCell_t unitsOfCell{};
+        for (size_t cell = 0; cell < numElements; ++cell) {
+            const auto row = cell / numColumns;
+            const auto column = cell % numColumns;
+            const auto box = (row / boxSize) * boxSize + column / boxSize;
+            for (auto unit: {row, numRows + column, numRows + numColumns + box}) {
+                unitsOfCell[cell][unit / unitWordSize] |= unitWord_t(1) << (unit % unitWordSize);
+            }
+        }
+        return unitsOfCell;
+    }
+
+    static const unitsOfCell_t unitsOfCell;
+
+    static const auto numIntersections = numBoxes * 2 * boxSize;
+
+    /** The boxSize cells a box shares with one of its rows or columns, and
+     *  the numValues - boxSize other cells of each of them. */
+    struct Intersection
+    {
+        std::array<index_t, boxSize> common;
+        std::array<index_t, numValues - boxSize> boxRest;
+        std::array<index_t, numValues - boxSize> lineRest;
+    };
+
+    using intersections_t = std::array<Intersection, numIntersections>;
+
+    static constexpr intersections_t createIntersections()
+    {
+        intersections_t intersections{};
+        size_t numFound = 0;
+        for (size_t box = 0; box < numBoxes; ++box) {
+            const auto& boxCells = units[numRows + numColumns + box];
+            for (size_t line = 0; line < 2 * boxSize; ++line) {
+                // the rows of the box, then its columns
+                const auto lineIndex = (line < boxSize) ?
+                    (box / boxSize) * boxSize + line :
+                    numRows + (box % boxSize) * boxSize + (line - boxSize);
+                const auto& lineCells = units[lineIndex];
+                auto& intersection = intersections[numFound++];
+                size_t numCommon = 0, numBoxRest = 0, numLineRest = 0;
+                for (auto cell: boxCells) {
+                    auto inLine = false;
+                    for (auto other: lineCells) {
+                        inLine = inLine || (other == cell);
+                    }
+                    if (inLine) {
+                        intersection.common[numCommon++] = cell;
+                    } else {
+                        intersection.boxRest[numBoxRest++] = cell;
+                    }
+                }
+                for (auto cell: lineCells) {
+                    auto inBox = false;
+                    for (auto other: boxCells) {
+                        inBox = inBox || (other == cell);
+                    }
+                    if (!inBox) {
+                        intersection.lineRest[numLineRest++] = cell;
+                    }
+                }
+            }
+        }
+        return intersections;
+    }
+
+    static const intersections_t intersections;
+
+    static cell_t& cellAt(Self& self, size_t index)
+    {
+        return self.state.cells[index / numColumns][index % numColumns];
+    }
+
+    static void record(Self& self, size_t index, const cell_t& previous)
+    {
+        assert(self.trailSize < self.trail.size());
+        auto& entry = self.trail[self.trailSize++];
+        entry.index = static_cast<index_t>(index);
+        entry.previous = previous;
+    }
+
+    static void undo(Self& self, size_t trailSize)
+    {
+        while (self.trailSize > trailSize) {
+            const auto& entry = self.trail[--self.trailSize];
+            cellAt(self, entry.index) = entry.previous;
+        }
+    }
+
+    /** Remember a cell whose value just got fixed, so that its value can be
+     *  erased from its peers by the next round of propagate(). */
+    static void enqueue(Self& self, size_t index)
+    {
+        assert(self.worklistSize < self.worklist.size());
+        self.worklist[self.worklistSize++] = static_cast<index_t>(index);
+    }
+
+    /** Hand an event to the trace sink, nothing at all without one. */
+    static void traceEvent(Self& self, trace::Event event, size_t index = trace::noCell, char value = 0)
+    {
+        if constexpr (TraceSink::enabled) {
+            self.sink.record(event, index, value);
+        }
+    }
+
+    static void assign(Self& self, size_t index, char value)
+    {
+        auto& cell = cellAt(self, index);
+        record(self, index, cell);
+        cell.clear();
+        cell.emplace(value);
+        --self.state.remaining;
+        enqueue(self, index);
+    }
+
+    /** Erase `value` from a cell, returns false if the cell has no potential
+     *  value left. */
+    static bool eliminate(Self& self, size_t index, char value)
+    {
+        auto& cell = cellAt(self, index);
+        if (cell.count(value) == 0) {
+            return true;
+        }
+
+        record(self, index, cell);
+        cell.erase(value);
+        traceEvent(self, trace::Event::Eliminate, index, value);
+        if (cell.empty()) {
+            traceEvent(self, trace::Event::Contradiction, index);
+            return false;
+        }
+
+        for (size_t word = 0; word < self.unitsToUpdate.size(); ++word) {
+            self.unitsToUpdate[word] |= unitsOfCell[index][word];
+        }
+        if (cell.size() == 1) {
+            traceEvent(self, trace::Event::NakedSingle, index, cell.single());
+            ++self.statistics.nakedSingles;
+            --self.state.remaining;
+            enqueue(self, index);
+        }
+        return true;
+    }
+
+    static void createState(Self& self, const board_t& board)
     {
         eraseState(self);
+        self.statistics = Stats();
 
-        for (auto i = 0; i < board.size(); ++i) {
-            self.state.cells.emplace_back();
-            for (auto j = 0; j < board[i].size(); ++j) {
-                self.state.cells[i].emplace_back();
+        for (size_t i = 0; i < board.size(); ++i) {
+            for (size_t j = 0; j < board[i].size(); ++j) {
                 if (board[i][j] == '.') {
                     ++self.state.remaining;
-                    for (auto k = 0; k < 9; ++k) {
-                        self.state.cells[i][j].emplace('1' + k);
-                    }
+                    self.state.cells[i][j] = cell_t(allValues);
                 } else {
                     self.state.cells[i][j].emplace(board[i][j]);
+                    enqueue(self, i * numColumns + j);
                 }
             }
         }
     }
 
-    static bool solved(const Solver& self)
+    /** Fix every value that only a single cell of the unit can hold.
+     *
+     *  Accumulating the potential values of the cells in `seenOnce` and the
+     *  ones seen before in `seenTwice` finds these values with a few bit
+     *  operations per cell. Returns false if a value can't be placed anywhere
+     *  in the unit, or if a cell is the only place for two values. */
+    static bool updateUnit(Self& self, const unit_t& unit)
     {
-        bool result = true;
-        for (auto i = 0; i < self.state.cells.size(); ++i) {
-            for (auto j = 0; j < self.state.cells[i].size(); ++j) {
-                if (self.state.cells[i][j].size() != 1) {
-                    result = false;
-                    break;
-                }
+        mask_t seenOnce = 0;
+        mask_t seenTwice = 0;
+        for (auto index: unit) {
+            const auto mask = candidates(self, index);
+            seenTwice |= seenOnce & mask;
+            seenOnce |= mask;
+        }
+        if (seenOnce != allValues) {
+            traceEvent(self, trace::Event::Contradiction);
+            return false;
+        }
+
+        const auto singles = static_cast<mask_t>(seenOnce & ~seenTwice);
+        if (singles == 0) {
+            return true;
+        }
+        for (auto index: unit) {
+            const auto mask = candidates(self, index);
+            const auto single = static_cast<mask_t>(mask & singles);
+            if (single == 0) {
+                continue;
+            }
+            if (std::popcount(single) > 1) {
+                traceEvent(self, trace::Event::Contradiction, index);
+                return false;
+            }
+            if (mask != single) {
+                const auto value = grid::symbol(std::countr_zero(single));
+                assign(self, index, value);
+                traceEvent(self, trace::Event::HiddenSingle, index, value);
+                ++self.statistics.hiddenSingles;
             }
         }
-        return result;
+        return true;
     }
 
-    static void eraseConflictInDestinationCell(const cell_t& src, cell_t& dst)
+    static bool hasUnitsToUpdate(const Self& self)
     {
-        if ((src != dst) && (src.size() == 1)) {
-            const auto conflictingValue = utils::getSingleCellValue(src);
-            dst.erase(conflictingValue);
+        for (auto word: self.unitsToUpdate) {
+            if (word != 0) {
+                return true;
+            }
         }
+        return false;
     }
 
-    static void updateCellFromRow(Solver& self, cell_t& cell, size_t rowIndex)
+    static bool updateMarkedUnits(Self& self)
     {
-        const auto& row = self.state.cells[rowIndex];
-        for (const auto& otherCell: row) {
-            eraseConflictInDestinationCell(otherCell, cell);
+        for (size_t word = 0; word < self.unitsToUpdate.size(); ++word) {
+            auto& unitsOfWord = self.unitsToUpdate[word];
+            while (unitsOfWord != 0) {
+                const auto unitIndex = word * unitWordSize + std::countr_zero(unitsOfWord);
+                unitsOfWord &= unitsOfWord - 1;
+                if (!updateUnit(self, units[unitIndex])) {
+                    return false;
+                }
+            }
         }
+        return true;
     }
 
-    static void updateCellFromColumn(Solver& self, cell_t& cell, size_t columnIndex)
+    using mask_t = cell_t::mask_t;
+
+    static const mask_t allValues = (1u << numValues) - 1;
+
+    static mask_t candidates(Self& self, size_t index)
     {
-        for (auto rowIndex = 0; rowIndex < self.state.cells.size(); ++rowIndex) {
-            const auto& otherCell = self.state.cells[rowIndex][columnIndex];
-            eraseConflictInDestinationCell(otherCell, cell);
-        }
+        return cellAt(self, index).bits();
     }
 
-    class Box_t
+    /** Erase every value of the mask `values` from a cell, returns false if
+     *  the cell has no potential value left. */
+    static bool eliminateAll(Self& self, size_t index, mask_t values)
     {
-        static const size_t uninitialised = 42;
-    public:
-        size_t rowIndex;
-        size_t columnIndex;
-        bool needsUpdate;
+        for (values &= candidates(self, index); values != 0; values &= values - 1) {
+            if (!eliminate(self, index, grid::symbol(std::countr_zero(values)))) {
+                return false;
+            }
+        }
+        return true;
+    }
 
-        Box_t(): rowIndex(uninitialised), columnIndex(uninitialised), needsUpdate(false)
-        {}
+    /** Pointing pairs and box/line reduction: a value that only fits into the
+     *  cells a box shares with a line can't be anywhere else in the line,
+     *  and a value that only fits into them within the line can't be
+     *  anywhere else in the box. */
+    static bool applyIntersections(Self& self)
+    {
+        for (const auto& intersection: intersections) {
+            mask_t common = 0, boxRest = 0, lineRest = 0;
+            for (auto cell: intersection.common) {
+                common |= candidates(self, cell);
+            }
+            for (auto cell: intersection.boxRest) {
+                boxRest |= candidates(self, cell);
+            }
+            for (auto cell: intersection.lineRest) {
+                lineRest |= candidates(self, cell);
+            }
 
-        static size_t size()
-        {
-            return boxSize;
+            const auto pointing = static_cast<mask_t>(common & ~boxRest & lineRest);
+            for (auto cell: intersection.lineRest) {
+                if ((pointing != 0) && !eliminateAll(self, cell, pointing)) {
+                    return false;
+                }
+            }
+            const auto claiming = static_cast<mask_t>(common & ~lineRest & boxRest);
+            for (auto cell: intersection.boxRest) {
+                if ((claiming != 0) && !eliminateAll(self, cell, claiming)) {
+                    return false;
+                }
+            }
         }
+        return true;
+    }
 
-        size_t height() const
-        {
-            assert(rowIndex != uninitialised);
-            return rowIndex + size();
+    /** Call `found(items, covered)` for every combination of `size` out of
+     *  the first `numItems` masks whose union `covered` has exactly `size`
+     *  bits, `items` having a bit set for each mask of the combination.
+     *
+     *  Only combinations of two or three are supported. Returns false as soon
+     *  as `found` does. */
+    template<typename Found>
+    static bool forEachSubset(const std::array<mask_t, numValues>& masks, size_t numItems, size_t size,
+        Found found)
+    {
+        for (size_t i = 0; i < numItems; ++i) {
+            for (auto j = i + 1; j < numItems; ++j) {
+                const auto pair = static_cast<mask_t>(masks[i] | masks[j]);
+                const auto pairSize = static_cast<size_t>(std::popcount(pair));
+                if (pairSize > size) {
+                    continue;
+                }
+                if (size == 2) {
+                    if (!found((1u << i) | (1u << j), pair)) {
+                        return false;
+                    }
+                    continue;
+                }
+                for (auto k = j + 1; k < numItems; ++k) {
+                    const auto triple = static_cast<mask_t>(pair | masks[k]);
+                    if ((std::popcount(triple) == 3) && !found((1u << i) | (1u << j) | (1u << k), triple)) {
+                        return false;
+                    }
+                }
+            }
         }
+        return true;
+    }
+
+    /** Naked subsets: when `size` cells of a unit hold only `size` values
+     *  between them, no other cell of the unit can hold these values. */
+    static bool applyNakedSubsets(Self& self, size_t size)
+    {
+        std::array<mask_t, numValues> masks;
+        std::array<std::uint8_t, numValues> positions;
+        for (const auto& unit: units) {
+            size_t numItems = 0;
+            for (size_t position = 0; position < unit.size(); ++position) {
+                const auto mask = candidates(self, unit[position]);
+                const auto count = static_cast<size_t>(std::popcount(mask));
+                if ((count >= 2) && (count <= size)) {
+                    masks[numItems] = mask;
+                    positions[numItems++] = static_cast<std::uint8_t>(position);
+                }
+            }
 
-        size_t width() const
-        {
-            assert(columnIndex != uninitialised);
-            return columnIndex + size();
+            const auto solved = forEachSubset(masks, numItems, size, [&](unsigned items, mask_t values) {
+                unsigned subset = 0;
+                for (; items != 0; items &= items - 1) {
+                    subset |= 1u << positions[std::countr_zero(items)];
+                }
+                for (size_t position = 0; position < unit.size(); ++position) {
+                    if (((subset >> position) & 1) == 0 && !eliminateAll(self, unit[position], values)) {
+                        return false;
+                    }
+                }
+                return true;
+            });
+            if (!solved) {
+                return false;
+            }
         }
+        return true;
+    }
+
+    /** Hidden subsets: when `size` values of a unit only fit into the same
+     *  `size` cells, these cells can't hold any other value. */
+    static bool applyHiddenSubsets(Self& self, size_t size)
+    {
+        std::array<mask_t, numValues> masks;
+        std::array<std::uint8_t, numValues> values;
+        for (const auto& unit: units) {
+            // the cells each value still fits into, values that are already fixed excluded
+            std::array<mask_t, numValues> cellsOfValue{};
+            mask_t fixed = 0;
+            for (size_t position = 0; position < unit.size(); ++position) {
+                const auto mask = candidates(self, unit[position]);
+                if (std::popcount(mask) == 1) {
+                    fixed |= mask;
+                    continue;
+                }
+                for (auto remaining = mask; remaining != 0; remaining &= remaining - 1) {
+                    cellsOfValue[std::countr_zero(remaining)] |= 1u << position;
+                }
+            }
+
+            size_t numItems = 0;
+            for (size_t value = 0; value < numValues; ++value) {
+                const auto count = static_cast<size_t>(std::popcount(cellsOfValue[value]));
+                if (((fixed >> value) & 1) == 0 && (count >= 2) && (count <= size)) {
+                    masks[numItems] = cellsOfValue[value];
+                    values[numItems++] = static_cast<std::uint8_t>(value);
+                }
+            }
 
-        bool isUninitialised() const
-        {
-            return (rowIndex == uninitialised) || (columnIndex == uninitialised);
+            const auto solved = forEachSubset(masks, numItems, size, [&](unsigned items, mask_t cells) {
+                mask_t subset = 0;
+                for (; items != 0; items &= items - 1) {
+                    subset |= 1u << values[std::countr_zero(items)];
+                }
+                for (; cells != 0; cells &= cells - 1) {
+                    if (!eliminateAll(self, unit[std::countr_zero(cells)], allValues & ~subset)) {
+                        return false;
+                    }
+                }
+                return true;
+            });
+            if (!solved) {
+                return false;
+            }
         }
+        return true;
+    }
 
-        size_t update(Solver& self)
-        {
-            size_t numFilledCells = 0;
+    /** X-Wing: when a value fits into exactly the same two columns of two
+     *  rows, one of the two rows holds it in each column, so no other row
+     *  can hold it in these columns. The same goes for rows and columns
+     *  swapped. */
+    static bool applyXWing(Self& self)
+    {
+        for (size_t value = 0; value < numValues; ++value) {
+            std::array<mask_t, numRows> columnsOfRow{};
+            std::array<mask_t, numColumns> rowsOfColumn{};
+            // fixed cells count as well: a cell fixed by an earlier elimination
+            // may not be propagated to its peers yet
+            for (size_t index = 0; index < numElements; ++index) {
+                if ((candidates(self, index) >> value) & 1) {
+                    columnsOfRow[index / numColumns] |= 1u << (index % numColumns);
+                    rowsOfColumn[index % numColumns] |= 1u << (index / numColumns);
+                }
+            }
 
-            auto cellsOfValue = std::unordered_map<char, std::vector<std::pair<size_t, size_t>>>();
-            for (char v = '1'; v <= maxValue; ++v)
-            {
-                cellsOfValue.emplace(v, decltype(cellsOfValue)::mapped_type());
+            if (!applyXWingToLines(self, value, columnsOfRow, true) ||
+                !applyXWingToLines(self, value, rowsOfColumn, false)) {
+                return false;
+            }
+        }
+        return true;
+    }
 
-                for (auto i = rowIndex; i < height(); ++i) {
-                    for (auto j = columnIndex; j < width(); ++j) {
-                        auto& boxCell = self.state.cells[i][j];
-                        if (boxCell.count(v) == 1) {
-                            cellsOfValue[v].emplace_back(i, j);
+    /** X-Wing on the rows (`byRows`) or on the columns, `positionsOfLine`
+     *  being the cells of each line that can hold the value. */
+    static bool applyXWingToLines(Self& self, size_t value, const std::array<mask_t, numRows>& positionsOfLine,
+        bool byRows)
+    {
+        const auto valueMask = static_cast<mask_t>(1u << value);
+        for (size_t first = 0; first < numRows; ++first) {
+            const auto positions = positionsOfLine[first];
+            if (std::popcount(positions) != 2) {
+                continue;
+            }
+            for (auto second = first + 1; second < numRows; ++second) {
+                if (positionsOfLine[second] != positions) {
+                    continue;
+                }
+                for (size_t line = 0; line < numRows; ++line) {
+                    if ((line == first) || (line == second)) {
+                        continue;
+                    }
+                    for (auto remaining = positions; remaining != 0; remaining &= remaining - 1) {
+                        const auto position = static_cast<size_t>(std::countr_zero(remaining));
+                        const auto index = byRows ? line * numColumns + position : position * numColumns + line;
+                        if (!eliminateAll(self, index, valueMask)) {
+                            return false;
                         }
                     }
                 }
+            }
+        }
+        return true;
+    }
 
-                if (cellsOfValue[v].size() == 1) {
-                    auto [i, j] = cellsOfValue[v][0];
-                    auto& cell = self.state.cells[i][j];
-                    if (cell.size() > 1) {
-                        // only a single cell has v as a potential value, but that cell
-                        // has still other values listed as potential values
-                        // let's write `v` into that cell
-                        cell.clear();
-                        cell.emplace(v);
-                        ++numFilledCells;
+    /** Try the enabled Techniques from the cheapest to the most expensive
+     *  and stop at the first one that erases a potential value, so that the
+     *  singles can pick up from there.
+     *
+     *  Returns false if the state turned out to be contradictory. */
+    static bool applyTechniques(Self& self)
+    {
+        const auto& techniques = self.techniques;
+        auto& statistics = self.statistics;
+        const auto trailSize = self.trailSize;
+        auto progress = [&](std::uint64_t& eliminations) {
+            eliminations += self.trailSize - trailSize;
+            return self.trailSize != trailSize;
+        };
+
+        if (techniques.intersections) {
+            if (!applyIntersections(self)) {
+                return false;
+            }
+            if (progress(statistics.intersectionEliminations)) {
+                return true;
+            }
+        }
+        if (techniques.nakedPairs) {
+            if (!applyNakedSubsets(self, 2)) {
+                return false;
+            }
+            if (progress(statistics.nakedSubsetEliminations)) {
+                return true;
+            }
+        }
+        if (techniques.hiddenPairs) {
+            if (!applyHiddenSubsets(self, 2)) {
+                return false;
+            }
+            if (progress(statistics.hiddenSubsetEliminations)) {
+                return true;
+            }
+        }
+        if (techniques.nakedTriples) {
+            if (!applyNakedSubsets(self, 3)) {
+                return false;
+            }
+            if (progress(statistics.nakedSubsetEliminations)) {
+                return true;
+            }
+        }
+        if (techniques.hiddenTriples) {
+            if (!applyHiddenSubsets(self, 3)) {
+                return false;
+            }
+            if (progress(statistics.hiddenSubsetEliminations)) {
+                return true;
+            }
+        }
+        if (techniques.xWing) {
+            if (!applyXWing(self)) {
+                return false;
+            }
+            progress(statistics.xWingEliminations);
+        }
+        return true;
+    }
+
+    /** Erase the value of every newly fixed cell from its peers, which may fix
+     *  further cells, then look for hidden singles in the units that lost a
+     *  potential value. Repeat until nothing changes, then try the enabled
+     *  Techniques and start over if one of them made progress.
+     *
+     *  Returns false if the state turned out to be contradictory. */
+    static bool propagate(Self& self)
+    {
+        for (;;) {
+            while ((self.worklistSize != 0) || hasUnitsToUpdate(self)) {
+                ++self.statistics.propagationPasses;
+                traceEvent(self, trace::Event::Pass);
+                const auto trailSize = self.trailSize;
+                while (self.worklistSize != 0) {
+                    const auto index = self.worklist[--self.worklistSize];
+                    const auto value = utils::getSingleCellValue(cellAt(self, index));
+                    for (const auto peer: peers[index]) {
+                        if (!eliminate(self, peer, value)) {
+                            self.worklistSize = 0;
+                            return false;
+                        }
                     }
                 }
+                self.statistics.peerEliminations += self.trailSize - trailSize;
+
+                if (!updateMarkedUnits(self)) {
+                    self.worklistSize = 0;
+                    return false;
+                }
             }
 
-            return numFilledCells;
+            if (!self.techniques.any()) {
+                return true;
+            }
+            const auto trailSize = self.trailSize;
+            if (!applyTechniques(self)) {
+                self.worklistSize = 0;
+                return false;
+            }
+            if (self.trailSize == trailSize) {
+                return true;
+            }
         }
+    }
 
-        static size_t box_index_of_cell_index(size_t cellIndex)
-        {
-            return cellIndex / size();
+    /** The unknown cell with the fewest potential values. */
+    static size_t mostConstrainedCell(Self& self)
+    {
+        auto best = numElements;
+        size_t fewest = numValues + 1;
+        for (size_t index = 0; index < numElements; ++index) {
+            const auto size = cellAt(self, index).size();
+            if ((size > 1) && (size < fewest)) {
+                best = index;
+                fewest = size;
+                if (fewest == 2) {
+                    break;
+                }
+            }
         }
+        return best;
+    }
 
-        static size_t box_index_of_cell(size_t rowIndex, size_t columnIndex)
-        {
-            const auto boxRowIndex = box_index_of_cell_index(rowIndex);
-            const auto boxColIndex = box_index_of_cell_index(columnIndex);
-            return boxRowIndex * size() + boxColIndex;
-        }
-    };
+    static bool isCancelled(const Self& self)
+    {
+        return (self.cancelled != nullptr) && self.cancelled->load(std::memory_order_relaxed);
+    }
 
-    using boxes_t = std::vector<Box_t>;
-    static boxes_t boxes;
+    // propagation passes between two looks at the clock for the deadline of solve(const Limits&)
+    static const std::uint64_t deadlineInterval = 64;
 
-    static Box_t& box_for_cell_index(size_t rowIndex, size_t columnIndex)
+    /** Whether the search must stop: another thread of solveParallel()
+     *  found a solution, or one of the limits of solve(const Limits&) is
+     *  reached, which is then kept in `self.stopReason`. */
+    static bool isStopped(Self& self)
     {
-        const auto boxIndex = Box_t::box_index_of_cell(rowIndex, columnIndex);
-        auto& box = boxes[boxIndex];
-        if (box.isUninitialised()) {
-            const auto boxRowIndex = Box_t::box_index_of_cell_index(rowIndex);
-            box.rowIndex = boxRowIndex * box.size();
-            const auto boxColumnIndex =  Box_t::box_index_of_cell_index(columnIndex);
-            box.columnIndex = boxColumnIndex * box.size();
+        if (self.limits == nullptr) {
+            return isCancelled(self);
+        }
+        if (self.stopReason) {
+            return true;
         }
 
-        return box;
+        const auto& limits = *self.limits;
+        const auto& stats = self.statistics;
+        const auto branches = stats.branchesTried - self.branchesAtStart;
+        const auto propagations = stats.propagationPasses - self.propagationsAtStart;
+        if (((limits.maxBranches != 0) && (branches >= limits.maxBranches)) ||
+            ((limits.maxPropagations != 0) && (propagations >= limits.maxPropagations))) {
+            self.stopReason = Status::OutOfBudget;
+        } else if (limits.deadline && (stats.propagationPasses >= self.nextClockCheck)) {
+            self.nextClockCheck = stats.propagationPasses + deadlineInterval;
+            if (std::chrono::steady_clock::now() >= *limits.deadline) {
+                self.stopReason = Status::TimedOut;
+            }
+        }
+        return self.stopReason.has_value();
     }
 
-    static void updateCellFromBox(Solver& self, cell_t& cell, size_t rowIndex, size_t columnIndex)
+    static bool search(Self& self, size_t depth = 0)
     {
-        const auto& box = box_for_cell_index(rowIndex, columnIndex);
-        for (auto i = box.rowIndex; i < box.height(); ++i) {
-            for (auto j = box.columnIndex; j < box.width(); ++j) {
-                const auto& otherCell = self.state.cells[i][j];
-                eraseConflictInDestinationCell(otherCell, cell);
+        if (isStopped(self)) {
+            // the cell the caller just assigned won't be propagated, its
+            // entry must not pile up with those of the caller's other values
+            self.worklistSize = 0;
+            self.unitsToUpdate = unitSet_t();
+            return false;
+        }
+        if (!propagate(self)) {
+            return false;
+        }
+        if (self.state.remaining == 0) {
+            traceEvent(self, trace::Event::Solution);
+            return true;
+        }
+
+        const auto index = mostConstrainedCell(self);
+        const auto candidates = cellAt(self, index);
+        const auto trailSize = self.trailSize;
+        const auto remaining = self.state.remaining;
+        self.statistics.branchesCreated += candidates.size();
+        self.statistics.maxDepth = std::max<std::uint64_t>(self.statistics.maxDepth, depth + 1);
+        for (auto value: candidates) {
+            assign(self, index, value);
+            traceEvent(self, trace::Event::Branch, index, value);
+            ++self.statistics.branchesTried;
+
+            if (search(self, depth + 1)) {
+                return true;
+            }
+
+            ++self.statistics.backtracks;
+            undo(self, trailSize);
+            traceEvent(self, trace::Event::Backtrack, index, value);
+            self.state.remaining = remaining;
+            if (self.stopReason || isCancelled(self)) {
+                break;
             }
         }
+        return false;
     }
 
-    static size_t updateMarkedBoxes(Solver& self)
+    /** Like search(), but go on after a solution until `limit` of them are
+     *  found, adding them up in `count`. The first one is copied to `first`.
+     *
+     *  A limit of zero counts every solution. */
+    static void countSearch(Self& self, size_t limit, size_t& count, state_t& first, size_t depth = 0)
     {
-        size_t numFilledCells = 0;
-        for (auto& box: boxes) {
-            if (box.needsUpdate) {
-                numFilledCells += box.update(self);
-                box.needsUpdate = false;
+        if (!propagate(self)) {
+            return;
+        }
+        if (self.state.remaining == 0) {
+            traceEvent(self, trace::Event::Solution);
+            if (count++ == 0) {
+                first = self.state;
+            }
+            return;
+        }
+
+        const auto index = mostConstrainedCell(self);
+        const auto candidates = cellAt(self, index);
+        const auto trailSize = self.trailSize;
+        const auto remaining = self.state.remaining;
+        self.statistics.branchesCreated += candidates.size();
+        self.statistics.maxDepth = std::max<std::uint64_t>(self.statistics.maxDepth, depth + 1);
+        for (auto value: candidates) {
+            assign(self, index, value);
+            traceEvent(self, trace::Event::Branch, index, value);
+            ++self.statistics.branchesTried;
+
+            const auto previousCount = count;
+            countSearch(self, limit, count, first, depth + 1);
+            if (count == previousCount) {
+                ++self.statistics.backtracks;
+            }
+
+            undo(self, trailSize);
+            traceEvent(self, trace::Event::Backtrack, index, value);
+            self.state.remaining = remaining;
+            if ((limit != 0) && (count >= limit)) {
+                return;
             }
         }
-        return numFilledCells;
     }
 
-    static bool updateCells(Solver& self)
+    /** Continue from a state that is already propagated to a fixpoint. */
+    static void loadState(Self& self, const state_t& state)
+    {
+        eraseState(self);
+        self.state = state;
+    }
+
+    static void enqueueFixedCells(Self& self)
     {
-        const auto remainingBeforeUpdate = self.state.remaining;
-        for (auto i = 0; i < self.state.cells.size(); ++i) {
-            for (auto j = 0; j < self.state.cells[i].size(); ++j) {
-                auto& cell = self.state.cells[i][j];
-                if (cell.size() != 1) {
-                    updateCellFromRow(self, cell, i);
-                    updateCellFromColumn(self, cell, j);
-                    updateCellFromBox(self, cell, i, j);
+        for (size_t index = 0; index < numElements; ++index) {
+            if (cellAt(self, index).size() == 1) {
+                enqueue(self, index);
+            }
+        }
+    }
+
+    // branches per thread in solveParallel(), more than one so that threads
+    // that finish early can pick up the work of the others
+    static const size_t branchesPerThread = 8;
 
-                    if (cell.size() == 1) {
-                        --self.state.remaining;
+    /** Split the search below the current, propagated state into at least
+     *  `count` independent branches by expanding it breadth first.
+     *
+     *  Branches that turn out contradictory are dropped. Returns true if a
+     *  branch is already a solution, which is then left in `self.state`.
+     *  `depth` is set to the number of levels expanded. */
+    static bool splitSearch(Self& self, size_t count, std::vector<state_t>& branches, size_t& depth)
+    {
+        branches.assign(1, self.state);
+        std::vector<state_t> nextBranches;
+        for (depth = 0; !branches.empty() && (branches.size() < count); ++depth) {
+            self.statistics.maxDepth = depth + 1;
+            nextBranches.clear();
+            for (const auto& branch: branches) {
+                loadState(self, branch);
+                const auto index = mostConstrainedCell(self);
+                const auto candidates = cellAt(self, index);
+                self.statistics.branchesCreated += candidates.size();
+                for (auto value: candidates) {
+                    assign(self, index, value);
+                    ++self.statistics.branchesTried;
+                    if (propagate(self)) {
+                        if (self.state.remaining == 0) {
+                            return true;
+                        }
+                        nextBranches.push_back(self.state);
                     } else {
-                        auto& box = box_for_cell_index(i, j);
-                        box.needsUpdate = true;
+                        ++self.statistics.backtracks;
                     }
+                    loadState(self, branch);
                 }
             }
+            branches.swap(nextBranches);
         }
+        return false;
+    }
 
-        self.state.remaining -= updateMarkedBoxes(self);
-
-        return remainingBeforeUpdate != self.state.remaining;
+    static NoSolution noSolution(const Self& self)
+    {
+        return NoSolution("There is no solution for this board. Remaining: " +
+            std::to_string(self.state.remaining) + " (" + std::to_string(unknownPercent(self)) + "%)");
     }
 
     static void updateBoardFromState(std::vector<std::vector<char>>& board, const state_t& state)
     {
-        for (auto i = 0; i < board.size(); ++i) {
-            for (auto j = 0; j < board[i].size(); ++j) {
+        // a solver loaded with a state has no board yet
+        if (board.size() != numRows) {
+            board.assign(numRows, std::vector<char>(numColumns, '.'));
+        }
+        for (size_t i = 0; i < board.size(); ++i) {
+            for (size_t j = 0; j < board[i].size(); ++j) {
                 board[i][j] = utils::getSingleCellValue(state.cells[i][j]);
             }
         }
     }
 };
 
-Solver::Private::boxes_t Solver::Private::boxes = Solver::Private::boxes_t(numBoxes);
+template<size_t BoxSize, typename TraceSink>
+const typename BasicSolver<BoxSize, TraceSink>::Private::peers_t BasicSolver<BoxSize, TraceSink>::Private::peers =
+    BasicSolver<BoxSize, TraceSink>::Private::createPeers();
+template<size_t BoxSize, typename TraceSink>
+const typename BasicSolver<BoxSize, TraceSink>::Private::units_t BasicSolver<BoxSize, TraceSink>::Private::units =
+    BasicSolver<BoxSize, TraceSink>::Private::createUnits();
+template<size_t BoxSize, typename TraceSink>
+const typename BasicSolver<BoxSize, TraceSink>::Private::unitsOfCell_t BasicSolver<BoxSize, TraceSink>::Private::unitsOfCell =
+    BasicSolver<BoxSize, TraceSink>::Private::createUnitsOfCell();
+template<size_t BoxSize, typename TraceSink>
+const typename BasicSolver<BoxSize, TraceSink>::Private::intersections_t BasicSolver<BoxSize, TraceSink>::Private::intersections =
+    BasicSolver<BoxSize, TraceSink>::Private::createIntersections();
+
 
+template<size_t BoxSize, typename TraceSink>
+BasicSolver<BoxSize, TraceSink>::BasicSolver(Engine engine)
+    : engine(engine)
+{
+    Private::eraseState(*this);
+}
 
-Solver::Solver(board_t& board)
-    : currentBoard(board)
+template<size_t BoxSize, typename TraceSink>
+BasicSolver<BoxSize, TraceSink>::BasicSolver(board_t& board, Engine engine)
+    : engine(engine)
+    , currentBoard(board)
 {
     Private::createState(*this, currentBoard);
 }
 
-bool Solver::ForkStates::isExhausted()
+template<size_t BoxSize, typename TraceSink>
+void BasicSolver<BoxSize, TraceSink>::setTechniques(const Techniques& techniques)
 {
-    return exhausted;
+    this->techniques = techniques;
 }
 
-bool Solver::ForkStates::isAlreadyForked()
+template<size_t BoxSize, typename TraceSink>
+void BasicSolver<BoxSize, TraceSink>::load(const board_t& board)
 {
-    return alreadyForked;
+    currentBoard = board;
+    Private::createState(*this, currentBoard);
 }
 
-bool Solver::ForkStates::findForkStates(const types::state_t& state)
+template<size_t BoxSize, typename TraceSink>
+void BasicSolver<BoxSize, TraceSink>::load(const state_t& state)
 {
-    for (auto row = 0; row < state.cells.size(); ++row) {
-        for (auto col = 0; col < state.cells[row].size(); ++col) {
-            if (state.cells[row][col].size() == 2) {
-                for (auto value: state.cells[row][col]) {
-                    forks.push_back(state);  // yes, this is a copy
-                    forks.back().cells[row][col].clear();
-                    forks.back().cells[row][col].emplace(value);
-                    --forks.back().remaining;
-                }
-            }
-        }
-    }
+    Private::loadState(*this, state);
+    Private::enqueueFixedCells(*this);
+    statistics = Stats();
+}
 
-    alreadyForked = true;
+template<size_t BoxSize, typename TraceSink>
+SolverBase::board_t BasicSolver<BoxSize, TraceSink>::solve()
+{
+    if (!trySolve()) {
+        throw Private::noSolution(*this);
+    }
 
-    forksIter = forks.begin();
+    Private::updateBoardFromState(currentBoard, state);
 
-    return !forks.empty();
+    return currentBoard;
 }
 
-auto Solver::ForkStates::nextForkState()
+template<size_t BoxSize, typename TraceSink>
+bool BasicSolver<BoxSize, TraceSink>::trySolve()
 {
-    auto next = forksIter;
-    ++forksIter;
-    if (forksIter == forks.end()) {
-        exhausted = true;
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
+    auto searchStart = start;
+    auto solved = false;
+    if (engine == Engine::DancingLinks) {
+        solved = dancingLinks.solve(state);
+    } else {
+        solved = Private::propagate(*this);
+        searchStart = clock::now();
+        solved = solved && Private::search(*this);
     }
-    return *next;
-}
+    const auto end = clock::now();
+    statistics.propagationSeconds += std::chrono::duration<double>(searchStart - start).count();
+    statistics.searchSeconds += std::chrono::duration<double>(end - searchStart).count();
 
-void Solver::ForkStates::reset()
-{
-    forks.clear();
-    exhausted = false;
-    alreadyForked = false;
-    forksIter = forks.end();
+    return solved;
 }
 
-size_t Solver::ForkStates::count() const
+template<size_t BoxSize, typename TraceSink>
+SolverBase::Status BasicSolver<BoxSize, TraceSink>::solve(const Limits& limits)
 {
-    return forks.size();
+    if (!limits.any()) {
+        return trySolve() ? Status::Solved : Status::NoSolution;
+    }
+
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
+    auto status = Status::NoSolution;
+    const auto propagated = Private::propagate(*this);
+    const auto searchStart = clock::now();
+    if (propagated) {
+        this->limits = &limits;
+        stopReason.reset();
+        nextClockCheck = 0;
+        branchesAtStart = statistics.branchesTried;
+        propagationsAtStart = statistics.propagationPasses;
+        if (Private::search(*this)) {
+            status = Status::Solved;
+        } else {
+            status = stopReason.value_or(Status::NoSolution);
+        }
+        this->limits = nullptr;
+    }
+    statistics.propagationSeconds += std::chrono::duration<double>(searchStart - start).count();
+    statistics.searchSeconds += std::chrono::duration<double>(clock::now() - searchStart).count();
+
+    return status;
 }
 
-Solver::board_t Solver::solve()
+template<size_t BoxSize, typename TraceSink>
+SolverBase::board_t BasicSolver<BoxSize, TraceSink>::solveParallel(size_t numThreads)
 {
-    while (!Private::solved(*this)) {
-        const auto updated = Private::updateCells(*this);
-        if (!updated) {
-            if (forkStates.isExhausted()) {
-                state = backupState;
-                throw IAmStuck("I tried " + std::to_string(forkStates.count()) +
-                    " forked states but still got stuck. Remaining: " +
-                    std::to_string(state.remaining) + " (" + std::to_string(unknownPercent()) + "%)");
-            } else if (forkStates.isAlreadyForked()) {
-                state = forkStates.nextForkState();
-            } else {
-                if (forkStates.findForkStates(state)) {
-                    backupState = state;
-                    state = forkStates.nextForkState();
-                } else {
-                    throw IAmStuck("I can't find a suitable next step. Remaining: " +
-                        std::to_string(state.remaining) + " (" + std::to_string(unknownPercent()) + "%)");
-                }
+    if ((engine != Engine::Propagation) || (numThreads == 1)) {
+        return solve();
+    }
+
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
+    const auto propagated = Private::propagate(*this);
+    const auto searchStart = clock::now();
+    statistics.propagationSeconds += std::chrono::duration<double>(searchStart - start).count();
+    if (!propagated) {
+        throw Private::noSolution(*this);
+    }
+
+    if (state.remaining != 0) {
+        const auto root = state;
+        ThreadPool pool(numThreads);
+        std::vector<state_t> branches;
+        size_t depth = 0;
+        if (!Private::splitSearch(*this, Private::branchesPerThread * pool.size(), branches, depth)) {
+            std::atomic<bool> solved = false;
+            std::mutex mutex;
+            auto solution = state_t();
+            auto solvers = std::vector<BasicSolver>(pool.size(), *this);
+            for (auto& solver: solvers) {
+                solver.statistics = Stats();
+            }
+            for (const auto& branch: branches) {
+                pool.submit([&](size_t workerIndex) {
+                    if (solved.load(std::memory_order_relaxed)) {
+                        return;
+                    }
+                    auto& solver = solvers[workerIndex];
+                    solver.cancelled = &solved;
+                    Private::loadState(solver, branch);
+                    if (Private::search(solver, depth)) {
+                        std::lock_guard lock(mutex);
+                        if (!solved) {
+                            solution = solver.state;
+                            solved = true;
+                        }
+                    }
+                });
             }
+            pool.wait();
+            for (const auto& solver: solvers) {
+                statistics += solver.statistics;
+            }
+            statistics.searchSeconds += std::chrono::duration<double>(clock::now() - searchStart).count();
+
+            if (!solved) {
+                Private::loadState(*this, root);
+                throw Private::noSolution(*this);
+            }
+            Private::loadState(*this, solution);
+        } else {
+            statistics.searchSeconds += std::chrono::duration<double>(clock::now() - searchStart).count();
         }
     }
 
@@ -343,19 +1091,129 @@ Solver::board_t Solver::solve()
     return currentBoard;
 }
 
-void Solver::printState(bool useSimpleFormat) const
+template<size_t BoxSize, typename TraceSink>
+size_t BasicSolver<BoxSize, TraceSink>::countSolutions(size_t limit)
+{
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
+    const auto propagated = Private::propagate(*this);
+    const auto searchStart = clock::now();
+    statistics.propagationSeconds += std::chrono::duration<double>(searchStart - start).count();
+
+    size_t count = 0;
+    if (propagated) {
+        auto first = state_t();
+        Private::countSearch(*this, limit, count, first);
+        if (count != 0) {
+            Private::loadState(*this, first);
+        }
+    }
+    statistics.searchSeconds += std::chrono::duration<double>(clock::now() - searchStart).count();
+
+    return count;
+}
+
+template<size_t BoxSize, typename TraceSink>
+void BasicSolver<BoxSize, TraceSink>::printState(bool useSimpleFormat) const
 {
     display::printState(state, useSimpleFormat);
 }
 
-Solver::remaining_t Solver::unknownCount() const
+template<size_t BoxSize, typename TraceSink>
+void BasicSolver<BoxSize, TraceSink>::appendValues(std::string& output) const
+{
+    display::appendValues(state, output);
+}
+
+template<size_t BoxSize, typename TraceSink>
+void BasicSolver<BoxSize, TraceSink>::storeValues(char* values) const
+{
+    display::storeValues(state, values);
+}
+
+template<size_t BoxSize, typename TraceSink>
+SolverBase::remaining_t BasicSolver<BoxSize, TraceSink>::unknownCount() const
 {
     return state.remaining;
 }
 
-Solver::percent_t Solver::unknownPercent() const
+template<size_t BoxSize, typename TraceSink>
+SolverBase::percent_t BasicSolver<BoxSize, TraceSink>::unknownPercent() const
 {
     return Private::unknownPercent(*this);
 }
 
+template<size_t BoxSize, typename TraceSink>
+const SolverBase::Stats& BasicSolver<BoxSize, TraceSink>::stats() const
+{
+    return statistics;
+}
+
+template<size_t BoxSize, typename TraceSink>
+TraceSink& BasicSolver<BoxSize, TraceSink>::traceSink()
+{
+    return sink;
+}
+
+template<size_t BoxSize, typename TraceSink>
+bool BasicSolver<BoxSize, TraceSink>::propagate()
+{
+    return Private::propagate(*this);
+}
+
+template<size_t BoxSize, typename TraceSink>
+bool BasicSolver<BoxSize, TraceSink>::assume(size_t index, char value)
+{
+    const auto& cell = Private::cellAt(*this, index);
+    if (cell.count(value) == 0) {
+        return false;
+    }
+    if (cell.size() != 1) {
+        Private::assign(*this, index, value);
+    }
+    return Private::propagate(*this);
+}
+
+template<size_t BoxSize, typename TraceSink>
+typename BasicSolver<BoxSize, TraceSink>::Checkpoint BasicSolver<BoxSize, TraceSink>::checkpoint() const
+{
+    return {trailSize, state.remaining};
+}
+
+template<size_t BoxSize, typename TraceSink>
+void BasicSolver<BoxSize, TraceSink>::rollback(const Checkpoint& checkpoint)
+{
+    Private::undo(*this, checkpoint.trailSize);
+    state.remaining = checkpoint.remaining;
+    worklistSize = 0;
+    unitsToUpdate = unitSet_t();
+}
+
+template<size_t BoxSize, typename TraceSink>
+const types::basic_cell_t<BoxSize>& BasicSolver<BoxSize, TraceSink>::candidates(size_t index) const
+{
+    return state.cells[index / grid::numColumns][index % grid::numColumns];
+}
+
+template<size_t BoxSize, typename TraceSink>
+bool BasicSolver<BoxSize, TraceSink>::findSolution(char* values)
+{
+    const auto checkpoint = this->checkpoint();
+    const auto solved = Private::search(*this);
+    if (solved) {
+        storeValues(values);
+    }
+    rollback(checkpoint);
+    return solved;
+}
+
+template class BasicSolver<2>;
+template class BasicSolver<3>;
+template class BasicSolver<4>;
+template class BasicSolver<5>;
+template class BasicSolver<2, trace::RingBuffer>;
+template class BasicSolver<3, trace::RingBuffer>;
+template class BasicSolver<4, trace::RingBuffer>;
+template class BasicSolver<5, trace::RingBuffer>;
+
 }  // namespace sudoku
@@ -1,43 +1,133 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <unordered_set>
 #include <vector>
 
+#include "constants.h"
+#include "dlx.h"
+#include "trace.h"
 #include "types.h"
 
 
 namespace sudoku
 {
 
-class Solver
+/** Everything about a solver that doesn't depend on the size of its grid. */
+class SolverBase
 {
-    using state_t = types::state_t;
+public:
+    /** The algorithms solve() can use, each of them finds a solution if there is one. */
+    enum class Engine
+    {
+        /// constraint propagation with a depth-first search
+        Propagation,
+        /// Algorithm X on dancing links, see DancingLinks
+        DancingLinks,
+    };
 
-    class ForkStates
+    /** Deductions the Propagation engine tries, cheapest first, whenever
+     *  naked and hidden singles are exhausted, before it resorts to branching.
+     *
+     *  Each of them only erases potential values, so any combination finds
+     *  the same solutions; stronger ones just leave less to the search. */
+    struct Techniques
     {
-        using forks_t = std::vector<types::state_t>;
-        forks_t forks;
-        bool exhausted = false;
-        bool alreadyForked = false;
-        forks_t::iterator forksIter = forks.end();
-    public:
-        bool isExhausted();
-        bool isAlreadyForked();
-        bool findForkStates(const types::state_t& state);
-        auto nextForkState();
-        void reset();
-        size_t count() const;
+        /// a value of a box confined to one of its rows or columns is erased
+        /// from the rest of that line (pointing pairs), and vice versa (box/line reduction)
+        bool intersections = false;
+        /// two cells of a unit with the same two potential values
+        bool nakedPairs = false;
+        /// two values of a unit that only fit in the same two cells
+        bool hiddenPairs = false;
+        /// three cells of a unit with only three potential values between them
+        bool nakedTriples = false;
+        /// three values of a unit that only fit in the same three cells
+        bool hiddenTriples = false;
+        /// a value confined to the same two columns of two rows, or the other way round
+        bool xWing = false;
+
+        static Techniques all()
+        {
+            return {true, true, true, true, true, true};
+        }
+
+        bool any() const
+        {
+            return intersections || nakedPairs || hiddenPairs || nakedTriples || hiddenTriples || xWing;
+        }
     };
 
-    types::board_t currentBoard;
-    ForkStates forkStates;
-    state_t backupState;
-    state_t state;
-    struct Private;
+    /** What the last solve() spent its time on.
+     *
+     *  The counters are plain increments on the hot paths, cheap enough to be
+     *  always on. They start from zero with every load(). Only the times are
+     *  filled by the DancingLinks engine. */
+    struct Stats
+    {
+        /// rounds of propagate(): erasing fixed values, then hidden singles
+        std::uint64_t propagationPasses = 0;
+        /// potential values erased from the peers of a fixed cell
+        std::uint64_t peerEliminations = 0;
+        /// cells fixed because a single potential value was left
+        std::uint64_t nakedSingles = 0;
+        /// cells fixed because a value fits nowhere else in their row, column or box
+        std::uint64_t hiddenSingles = 0;
+        /// potential values erased by each of the Techniques
+        std::uint64_t intersectionEliminations = 0;
+        std::uint64_t nakedSubsetEliminations = 0;
+        std::uint64_t hiddenSubsetEliminations = 0;
+        std::uint64_t xWingEliminations = 0;
+        /// potential values of the cells the search branched on
+        std::uint64_t branchesCreated = 0;
+        /// branches the search actually went down
+        std::uint64_t branchesTried = 0;
+        /// branches that led to a contradiction and got undone
+        std::uint64_t backtracks = 0;
+        /// the deepest nesting of branches
+        std::uint64_t maxDepth = 0;
+        /// seconds propagating the givens before any branching
+        double propagationSeconds = 0.0;
+        /// seconds searching after the first propagation
+        double searchSeconds = 0.0;
+
+        /** Add up the counters and times, keep the largest depth. */
+        Stats& operator+=(const Stats& other);
+    };
+
+    /** Bounds on the cost of solve(const Limits&), none of them by default. */
+    struct Limits
+    {
+        /// stop the search once this point in time has passed
+        std::optional<std::chrono::steady_clock::time_point> deadline;
+        /// stop the search after this many branches, zero for no limit
+        std::uint64_t maxBranches = 0;
+        /// stop the search after this many propagation passes, zero for no limit
+        std::uint64_t maxPropagations = 0;
+
+        bool any() const
+        {
+            return deadline || (maxBranches != 0) || (maxPropagations != 0);
+        }
+    };
+
+    /** How solve(const Limits&) ended. */
+    enum class Status
+    {
+        Solved,
+        NoSolution,
+        /// the deadline passed before the search was over
+        TimedOut,
+        /// the branches or the propagation passes ran out before the search was over
+        OutOfBudget,
+    };
 
-public:
     class Exception: public std::runtime_error
     {
     public:
@@ -46,10 +136,10 @@ public:
         virtual ~Exception() noexcept = 0;
     };
 
-    class IAmStuck: public Exception
+    class NoSolution: public Exception
     {
     public:
-        explicit IAmStuck(const std::string& msg): Exception(msg)
+        explicit NoSolution(const std::string& msg): Exception(msg)
         {}
     };
 
@@ -57,14 +147,191 @@ public:
     using board_t = types::board_t;
     using remaining_t = types::remaining_t;
     using percent_t = types::percent_t;
+};
+
+/** A solver for grids with boxes of `BoxSize` x `BoxSize` cells, 9x9 for a
+ *  `BoxSize` of 3.
+ *
+ *  The sizes from constants::minBoxSize to constants::maxBoxSize are
+ *  instantiated in solver.cpp; the peer and unit tables and the type of the
+ *  candidate masks are fixed at compile time for each of them.
+ *
+ *  The propagation and the search report their steps to a `TraceSink`, see
+ *  trace::NullSink, which compiles them away, and trace::RingBuffer; both
+ *  are instantiated. The threads of solveParallel() aren't traced. */
+template<size_t BoxSize, typename TraceSink = trace::NullSink>
+class BasicSolver: public SolverBase
+{
+    using grid = constants::Grid<BoxSize>;
 
-    Solver(board_t& board);
+private:
+    using state_t = types::basic_state_t<BoxSize>;
+    using cell_t = types::basic_cell_t<BoxSize>;
+    // the index of a cell
+    using index_t = std::conditional_t<(grid::numElements <= 256), std::uint8_t, std::uint16_t>;
+
+    struct TrailEntry
+    {
+        index_t index;
+        cell_t previous;
+    };
 
+    // every change removes at least one potential value from an unknown cell,
+    // so a single path of the search can't record more changes than this
+    static const size_t maxTrailSize = grid::numElements * (grid::numValues - 1);
+    using trail_t = std::array<TrailEntry, maxTrailSize>;
+
+    // one bit for each row, column and box, in as few words as possible
+    static const size_t numUnits = grid::numRows + grid::numColumns + grid::numBoxes;
+    using unitWord_t = std::conditional_t<(numUnits <= 32), std::uint32_t, std::uint64_t>;
+    using unitSet_t = std::array<unitWord_t, (numUnits + 63) / 64>;
+
+    Engine engine;
+    Techniques techniques;
+    // the matrix of the DancingLinks engine, linked once for every board the solver gets
+    BasicDancingLinks<BoxSize> dancingLinks;
+    types::board_t currentBoard;
+    trail_t trail;
+    size_t trailSize = 0;
+    // cells that got fixed but whose value is not yet erased from their peers;
+    // a cell is fixed at most once along a path of the search
+    using worklist_t = std::array<index_t, grid::numElements>;
+    worklist_t worklist;
+    size_t worklistSize = 0;
+    // rows, columns and boxes (one bit each) that lost a potential value
+    // since they were last searched for hidden singles
+    unitSet_t unitsToUpdate = {};
+    // set by another thread of solveParallel() to stop the search
+    const std::atomic<bool>* cancelled = nullptr;
+    // the limits of solve(const Limits&) during its search, and which one stopped it
+    const Limits* limits = nullptr;
+    std::optional<Status> stopReason;
+    // the number of propagation passes at which to look at the clock next
+    std::uint64_t nextClockCheck = 0;
+    // the counters of the statistics as the search of solve(const Limits&)
+    // started, which its budgets are counted from
+    std::uint64_t branchesAtStart = 0;
+    std::uint64_t propagationsAtStart = 0;
+    Stats statistics;
+    state_t state;
+    [[no_unique_address]] TraceSink sink;
+    struct Private;
+
+public:
+    /** A solver without a board, see load(). */
+    explicit BasicSolver(Engine engine = Engine::Propagation);
+    BasicSolver(board_t& board, Engine engine = Engine::Propagation);
+
+    /** Choose the deductions of the Propagation engine beyond naked and
+     *  hidden singles, none by default. */
+    void setTechniques(const Techniques& techniques);
+
+    /** Replace the board of the solver, so that a single solver can work
+     *  through many boards. */
+    void load(const board_t& board);
+
+    /** Continue from a partially reduced state, e.g. one of LaneSolver. */
+    void load(const state_t& state);
+
+    /** Solve the board with the engine chosen at construction.
+     *
+     *  The Propagation engine runs constraint propagation and a depth-first
+     *  search. Whenever the propagation gets stuck the search branches on the
+     *  unknown cell with the fewest potential values and backtracks by undoing
+     *  the recorded changes, so the returned board is always a solution.
+     *
+     *  Throws NoSolution if the board can't be solved. */
     board_t solve();
 
+    /** Like solve(), but returns false rather than throwing if there is no
+     *  solution, and leaves the solution in the state of the solver rather
+     *  than building a board; see appendValues(). */
+    bool trySolve();
+
+    /** Like trySolve(), but give up once one of `limits` is reached, without
+     *  an exception: the Status tells how the search ended.
+     *
+     *  The limits are checked as the search enters a branch, never during a
+     *  propagation, and the clock is read only after at least 64 passes of
+     *  propagation since its last reading, to keep it off the hot path. So
+     *  the budgets may be overrun by the propagation of one branch,
+     *  techniques included, and the deadline by that plus 64 passes. The
+     *  budgets count the branches and passes of this search alone, so a
+     *  retry gets all of its budget, and the propagation of the givens
+     *  isn't limited or counted against them at all. When solving is cut
+     *  short the state is left as far as the propagation of the givens got,
+     *  the partially reduced board printState() and appendValues() show,
+     *  for the caller to report or to retry with a larger budget.
+     *
+     *  With limits the search is the one of the Propagation engine, whatever
+     *  the engine of the solver; without any this is trySolve(). */
+    Status solve(const Limits& limits);
+
+    /** Like solve(), but the branches of the search are explored by
+     *  `numThreads` threads (zero means one per hardware thread), each with
+     *  a private copy of the solver. The first thread to find a solution
+     *  cancels the others.
+     *
+     *  Only the Propagation engine searches in parallel. */
+    board_t solveParallel(size_t numThreads = 0);
+
+    /** Count the solutions of the board, but stop searching as soon as
+     *  there are `limit` of them (zero means no limit). A limit of 2 tells
+     *  whether the solution is unique at little more than the cost of
+     *  solve(): the search only goes on until a second solution turns up.
+     *
+     *  The search is the one of the Propagation engine, whatever the engine
+     *  of the solver. If there is a solution, the state is left at the
+     *  first one found; otherwise it is left wherever the propagation of
+     *  the givens stopped. */
+    size_t countSolutions(size_t limit = 2);
+
     void printState(bool useSimpleFormat) const;
+
+    /** Append the value of every cell of the state, row by row, to `output`,
+     *  '.' for the cells that are still unknown; see display::appendValues(). */
+    void appendValues(std::string& output) const;
+
+    /** Like appendValues(), but write the values to the grid::numElements
+     *  characters at `values`, without allocating. */
+    void storeValues(char* values) const;
     remaining_t unknownCount() const;
     percent_t unknownPercent() const;
+    const Stats& stats() const;
+
+    /** The sink of the steps of the solver, to clear it or to read it. */
+    TraceSink& traceSink();
+
+    /** A point of the history of the state to go back to, see rollback(). */
+    struct Checkpoint
+    {
+        size_t trailSize = 0;
+        remaining_t remaining = 0;
+    };
+
+    /** The incremental interface behind BasicSession: propagate() the board
+     *  loaded last, then assume() one value after the other, taking a
+     *  checkpoint() before each of them to rollback() to.
+     *
+     *  Every change since the load is recorded, so rolling back is as cheap
+     *  as the changes it undoes. Both return false if the state turned out
+     *  to be contradictory, in which case it must be rolled back before it
+     *  is propagated any further. */
+    bool propagate();
+    bool assume(size_t index, char value);
+    Checkpoint checkpoint() const;
+    void rollback(const Checkpoint& checkpoint);
+
+    /** The potential values of the cell at `index`, row by row. */
+    const types::basic_cell_t<BoxSize>& candidates(size_t index) const;
+
+    /** Search for a solution of the propagated state, write its values to
+     *  the grid::numElements characters at `values` like storeValues(),
+     *  and return to the state as it was. Returns false if there is no
+     *  solution, leaving `values` alone. */
+    bool findSolution(char* values);
 };
 
+using Solver = BasicSolver<constants::boxSize>;
+
 }  // namespace sudoku
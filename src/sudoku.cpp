@@ -0,0 +1,91 @@
+#include <string_view>
+
+#include "parser.h"
+#include "solver.h"
+#include "sudoku.h"
+
+
+namespace sudoku
+{
+
+namespace
+{
+
+static_assert(SUDOKU_CELLS == constants::numElements);
+
+/** Parse a board of the C interface straight into the state of `solver`. */
+bool load(Solver& solver, const char* board, size_t length, size_t* errorPosition)
+{
+    types::state_t state;
+    parser::Error error;
+    if (!parser::parseLine(std::string_view(board, length), state, error)) {
+        if (errorPosition != nullptr) {
+            *errorPosition = error.position;
+        }
+        return false;
+    }
+    solver.load(state);
+    return true;
+}
+
+sudoku_status solve(Solver& solver, const char* board, size_t length, char* solution, size_t* errorPosition)
+{
+    if (!load(solver, board, length, errorPosition)) {
+        return SUDOKU_INVALID;
+    }
+    if (!solver.trySolve()) {
+        return SUDOKU_UNSOLVABLE;
+    }
+    solver.storeValues(solution);
+    return SUDOKU_SOLVED;
+}
+
+}  // namespace
+
+}  // namespace sudoku
+
+
+extern "C"
+{
+
+int sudoku_api_version(void)
+{
+    return SUDOKU_API_VERSION;
+}
+
+sudoku_status sudoku_solve(const char* board, size_t length, char* solution, size_t* error_position)
+{
+    sudoku::Solver solver;
+    return sudoku::solve(solver, board, length, solution, error_position);
+}
+
+size_t sudoku_solve_batch(const char* boards, size_t count, char* solutions, sudoku_status* statuses)
+{
+    sudoku::Solver solver;
+    size_t numSolved = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const auto offset = i * SUDOKU_CELLS;
+        statuses[i] = sudoku::solve(solver, boards + offset, SUDOKU_CELLS, solutions + offset, nullptr);
+        numSolved += (statuses[i] == SUDOKU_SOLVED);
+    }
+    return numSolved;
+}
+
+sudoku_status sudoku_count_solutions(const char* board, size_t length, size_t limit, size_t* count,
+    char* first_solution)
+{
+    sudoku::Solver solver;
+    if (!sudoku::load(solver, board, length, nullptr)) {
+        return SUDOKU_INVALID;
+    }
+    *count = solver.countSolutions(limit);
+    if (*count == 0) {
+        return SUDOKU_UNSOLVABLE;
+    }
+    if (first_solution != nullptr) {
+        solver.storeValues(first_solution);
+    }
+    return SUDOKU_SOLVED;
+}
+
+}  // extern "C"
@@ -0,0 +1,77 @@
+#pragma once
+
+/** The C interface of libsudoku, for calling the solver in-process from C
+ *  and from other languages.
+ *
+ *  A board is the 81 characters of a 9x9 grid, row by row, with '.' or '0'
+ *  for an unknown cell, as in parser::parseLine(); a solution is the 81
+ *  values in the same order, without a terminating null character.
+ *
+ *  Every call is reentrant: the solver lives on the stack of the caller,
+ *  with no heap allocation behind it, so any number of threads may call
+ *  in at once, and solving a valid board doesn't allocate. Only a
+ *  rejected board allocates, for the message the parser builds along the
+ *  way.
+ *
+ *  The functions and the values of the types below only ever get added
+ *  to, SUDOKU_API_VERSION counts the additions. The shared library exports
+ *  nothing else, and its SONAME is libsudoku.so.SUDOKU_API_VERSION. */
+
+#include <stddef.h>
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define SUDOKU_API_VERSION 1
+
+/** The functions of the interface are the only symbols the library exports,
+ *  everything else is compiled with hidden visibility. */
+#if defined(__GNUC__)
+#define SUDOKU_EXPORT __attribute__((visibility("default")))
+#else
+#define SUDOKU_EXPORT
+#endif
+
+/** The number of cells of a board, and of characters of a solution. */
+#define SUDOKU_CELLS 81
+
+typedef enum sudoku_status
+{
+    /** the board has a solution, written to the buffer of the caller */
+    SUDOKU_SOLVED = 0,
+    /** the board has no solution */
+    SUDOKU_UNSOLVABLE = 1,
+    /** the board is malformed, or a given repeats in a row, column or box */
+    SUDOKU_INVALID = 2,
+} sudoku_status;
+
+/** The SUDOKU_API_VERSION the library was built with. */
+SUDOKU_EXPORT int sudoku_api_version(void);
+
+/** Solve the board of `length` characters at `board` into the
+ *  SUDOKU_CELLS characters at `solution`, which are left alone unless the
+ *  board is solved. For an invalid board, `error_position` (if not null)
+ *  is set to the offset of the offending character. */
+SUDOKU_EXPORT sudoku_status sudoku_solve(const char* board, size_t length, char* solution, size_t* error_position);
+
+/** Solve the `count` boards of SUDOKU_CELLS characters each, back to back
+ *  at `boards`, into the solutions back to back at `solutions`, setting
+ *  the status of each board in `statuses`. Returns the number of boards
+ *  solved. */
+SUDOKU_EXPORT size_t sudoku_solve_batch(const char* boards, size_t count, char* solutions, sudoku_status* statuses);
+
+/** Count the solutions of the board of `length` characters at `board`
+ *  into `count`, stopping at `limit` of them (zero means no limit, 2 tells
+ *  whether the solution is unique). The first solution is written to the
+ *  SUDOKU_CELLS characters at `first_solution` if it isn't null. Returns
+ *  SUDOKU_INVALID for an invalid board, leaving `count` alone, and
+ *  SUDOKU_SOLVED or SUDOKU_UNSOLVABLE otherwise. */
+SUDOKU_EXPORT sudoku_status sudoku_count_solutions(const char* board, size_t length, size_t limit, size_t* count,
+    char* first_solution);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
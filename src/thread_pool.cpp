@@ -0,0 +1,125 @@
+#include <algorithm>
+
+#include "thread_pool.h"
+
+
+namespace sudoku
+{
+
+ThreadPool::ThreadPool(size_t numWorkers)
+{
+    if (numWorkers == 0) {
+        numWorkers = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    queues.reserve(numWorkers);
+    for (size_t i = 0; i < numWorkers; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+
+    workers.reserve(numWorkers);
+    for (size_t i = 0; i < numWorkers; ++i) {
+        workers.emplace_back(&ThreadPool::work, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    wait();
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+    for (auto& worker: workers) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::size() const
+{
+    return workers.size();
+}
+
+void ThreadPool::submit(task_t task)
+{
+    auto& queue = *queues[nextQueue++ % queues.size()];
+    {
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard lock(mutex);
+        ++numQueued;
+        ++numUnfinished;
+    }
+    taskAvailable.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock lock(mutex);
+    allDone.wait(lock, [this] { return numUnfinished == 0; });
+}
+
+bool ThreadPool::tryPop(size_t workerIndex, task_t& task)
+{
+    auto& queue = *queues[workerIndex];
+    std::lock_guard lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::trySteal(size_t workerIndex, task_t& task)
+{
+    for (size_t i = 1; i < queues.size(); ++i) {
+        auto& queue = *queues[(workerIndex + i) % queues.size()];
+        std::lock_guard lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::work(size_t workerIndex)
+{
+    task_t task;
+    while (true) {
+        {
+            std::unique_lock lock(mutex);
+            taskAvailable.wait(lock, [this] { return stopping || (numQueued != 0); });
+            if (numQueued == 0) {
+                return;
+            }
+            // claim a task, it is in one of the queues
+            --numQueued;
+        }
+
+        while (!tryPop(workerIndex, task) && !trySteal(workerIndex, task)) {
+            // another worker took the task we looked at, but every claim is
+            // backed by a queued task, so there is one left for us elsewhere
+            std::this_thread::yield();
+        }
+
+        task(workerIndex);
+        task = nullptr;
+
+        bool finishedAll;
+        {
+            std::lock_guard lock(mutex);
+            finishedAll = (--numUnfinished == 0);
+        }
+        if (finishedAll) {
+            allDone.notify_all();
+        }
+    }
+}
+
+}  // namespace sudoku
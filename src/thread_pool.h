@@ -0,0 +1,158 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace sudoku
+{
+
+/** A fixed set of worker threads with a task deque for each of them.
+ *
+ *  Submitted tasks are spread over the deques round-robin. A worker runs
+ *  the tasks of its own deque newest first, and once that is empty it
+ *  steals the oldest task of another worker, so uneven tasks still keep
+ *  every worker busy. Tasks get the index of the worker running them,
+ *  which lets them use per-worker resources (e.g. a Solver) without locking. */
+class ThreadPool
+{
+public:
+    using task_t = std::function<void(size_t workerIndex)>;
+
+    /** Zero workers means one per hardware thread. */
+    explicit ThreadPool(size_t numWorkers = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const;
+
+    void submit(task_t task);
+
+    /** Block until every submitted task has finished. */
+    void wait();
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<task_t> tasks;
+    };
+
+    bool tryPop(size_t workerIndex, task_t& task);
+    bool trySteal(size_t workerIndex, task_t& task);
+    void work(size_t workerIndex);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> nextQueue = 0;
+
+    std::mutex mutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable allDone;
+    size_t numQueued = 0;
+    size_t numUnfinished = 0;
+    bool stopping = false;
+};
+
+/** The reorder buffer of Batch and Generator: chunks of work processed on
+ *  a ThreadPool, then written strictly in the order they were submitted.
+ *
+ *  Once `maxInFlight` chunks are queued or running, submit() waits for the
+ *  oldest one and writes it. Written chunks are handed out again by next()
+ *  as they are, so their buffers stop growing after the first few; the
+ *  caller resets whatever it needs to. */
+template<typename Chunk>
+class OrderedChunks
+{
+public:
+    using process_t = std::function<void(Chunk& chunk, size_t workerIndex)>;
+    using write_t = std::function<void(Chunk& chunk)>;
+
+    OrderedChunks(ThreadPool& pool, size_t maxInFlight, process_t process, write_t write)
+        : pool(pool)
+        , maxInFlight(std::max<size_t>(maxInFlight, 1))
+        , process(std::move(process))
+        , write(std::move(write))
+    {}
+
+    OrderedChunks(const OrderedChunks&) = delete;
+    OrderedChunks& operator=(const OrderedChunks&) = delete;
+
+    /** A chunk to fill and submit(), a written one if there is any. */
+    std::unique_ptr<Chunk> next()
+    {
+        if (spareChunks.empty()) {
+            return std::make_unique<Chunk>();
+        }
+        auto chunk = std::move(spareChunks.back());
+        spareChunks.pop_back();
+        return chunk;
+    }
+
+    void submit(std::unique_ptr<Chunk> chunk)
+    {
+        // a deque keeps its elements in place, so the task can refer to its entry
+        inFlight.push_back(Entry{std::move(chunk)});
+        auto& entry = inFlight.back();
+        pool.submit([this, &entry](size_t workerIndex) {
+            process(*entry.chunk, workerIndex);
+            {
+                std::lock_guard lock(mutex);
+                entry.done = true;
+            }
+            chunkDone.notify_all();
+        });
+        if (inFlight.size() >= maxInFlight) {
+            writeFirst();
+        }
+    }
+
+    /** Write every chunk still in flight, in order. */
+    void finish()
+    {
+        while (!inFlight.empty()) {
+            writeFirst();
+        }
+        // the last tasks may still be notifying `chunkDone`
+        pool.wait();
+    }
+
+private:
+    struct Entry
+    {
+        std::unique_ptr<Chunk> chunk;
+        bool done = false;
+    };
+
+    void writeFirst()
+    {
+        auto& entry = inFlight.front();
+        {
+            std::unique_lock lock(mutex);
+            chunkDone.wait(lock, [&entry] { return entry.done; });
+        }
+        write(*entry.chunk);
+        spareChunks.push_back(std::move(entry.chunk));
+        inFlight.pop_front();
+    }
+
+    ThreadPool& pool;
+    size_t maxInFlight;
+    process_t process;
+    write_t write;
+    std::deque<Entry> inFlight;
+    std::vector<std::unique_ptr<Chunk>> spareChunks;
+    std::mutex mutex;
+    std::condition_variable chunkDone;
+};
+
+}  // namespace sudoku
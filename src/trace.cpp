@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <string>
+
+#include "trace.h"
+
+
+namespace sudoku
+{
+
+namespace trace
+{
+
+namespace
+{
+
+const char magic[8] = {'S', 'D', 'K', 'T', 'R', 'A', 'C', 'E'};
+const std::uint32_t version = 1;
+
+struct Header
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t numColumns;
+    std::uint64_t numEvents;
+    std::uint64_t numDropped;
+};
+
+// events read at once from an input of unknown size
+const size_t readChunk = 1 << 16;
+
+/** The bytes left in `input` if it can seek, nothing otherwise. */
+std::optional<std::uint64_t> remainingSize(std::istream& input)
+{
+    const auto position = input.tellg();
+    if (position == std::istream::pos_type(-1)) {
+        input.clear();
+        return std::nullopt;
+    }
+    input.seekg(0, std::ios::end);
+    const auto end = input.tellg();
+    input.seekg(position);
+    if ((end == std::istream::pos_type(-1)) || !input) {
+        input.clear();
+        input.seekg(position);
+        return std::nullopt;
+    }
+    return static_cast<std::uint64_t>(end - position);
+}
+
+/** Chrome wants microseconds, as a number that may have a fraction. */
+std::string microsecondsOf(std::uint64_t nanoseconds)
+{
+    auto text = std::to_string(nanoseconds / 1000);
+    const auto fraction = nanoseconds % 1000;
+    if (fraction != 0) {
+        const auto digits = std::to_string(1000 + fraction);
+        text += '.';
+        text += digits.substr(1);
+    }
+    return text;
+}
+
+void writeEvent(std::ostream& output, const Record& record, size_t numColumns, const char* phase, bool& first)
+{
+    output << (first ? "\n" : ",\n") << "{\"name\":\"" << nameOf(record.event) << "\",\"ph\":\"" << phase
+        << "\",\"ts\":" << microsecondsOf(record.nanoseconds) << ",\"pid\":1,\"tid\":1";
+    if (phase[0] == 'i') {
+        output << ",\"s\":\"t\"";
+    }
+    output << ",\"args\":{\"depth\":" << record.depth;
+    if (record.cell != noCell) {
+        output << ",\"row\":" << (record.cell / numColumns) << ",\"column\":" << (record.cell % numColumns);
+    }
+    if (record.value != 0) {
+        output << ",\"value\":\"" << record.value << '"';
+    }
+    output << "}}";
+    first = false;
+}
+
+}  // namespace
+
+
+const char* nameOf(Event event)
+{
+    switch (event) {
+        case Event::Pass:
+            return "pass";
+        case Event::Eliminate:
+            return "eliminate";
+        case Event::NakedSingle:
+            return "naked single";
+        case Event::HiddenSingle:
+            return "hidden single";
+        case Event::Branch:
+            return "branch";
+        case Event::Backtrack:
+            return "backtrack";
+        case Event::Contradiction:
+            return "contradiction";
+        case Event::Solution:
+            return "solution";
+    }
+    return "unknown";
+}
+
+RingBuffer::RingBuffer(size_t capacity)
+    : records(std::max<size_t>(capacity, 1))
+    , start(clock::now())
+{}
+
+void RingBuffer::clear()
+{
+    numRecorded = 0;
+    depth = 0;
+    start = clock::now();
+}
+
+std::vector<Record> RingBuffer::events() const
+{
+    if (numRecorded <= records.size()) {
+        return std::vector<Record>(records.begin(), records.begin() + numRecorded);
+    }
+    const auto oldest = records.begin() + numRecorded % records.size();
+    std::vector<Record> events(oldest, records.end());
+    events.insert(events.end(), records.begin(), oldest);
+    return events;
+}
+
+std::uint64_t RingBuffer::numDropped() const
+{
+    return (numRecorded > records.size()) ? numRecorded - records.size() : 0;
+}
+
+void RingBuffer::write(std::ostream& output, size_t numColumns) const
+{
+    const auto events = this->events();
+    Header header;
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.numColumns = static_cast<std::uint32_t>(numColumns);
+    header.numEvents = events.size();
+    header.numDropped = numDropped();
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.write(reinterpret_cast<const char*>(events.data()), events.size() * sizeof(Record));
+}
+
+bool read(std::istream& input, Trace& trace)
+{
+    Header header;
+    if (!input.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        (std::memcmp(header.magic, magic, sizeof(magic)) != 0) || (header.version != version) ||
+        (header.numColumns == 0)) {
+        return false;
+    }
+
+    // a corrupt or truncated file must not make the events take more
+    // memory than the input holds
+    const auto available = remainingSize(input);
+    if (available && (header.numEvents > *available / sizeof(Record))) {
+        return false;
+    }
+
+    trace.numColumns = header.numColumns;
+    trace.numDropped = header.numDropped;
+    trace.events.clear();
+    while (trace.events.size() < header.numEvents) {
+        const auto numRead = trace.events.size();
+        const auto numEvents = static_cast<size_t>(std::min<std::uint64_t>(header.numEvents - numRead, readChunk));
+        trace.events.resize(numRead + numEvents);
+        if (!input.read(reinterpret_cast<char*>(trace.events.data() + numRead), numEvents * sizeof(Record))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void writeChromeJson(const Trace& trace, std::ostream& output)
+{
+    output << "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped\":" << trace.numDropped << "},\"traceEvents\":[";
+    auto first = true;
+    size_t numOpen = 0;
+    for (const auto& record: trace.events) {
+        switch (record.event) {
+            case Event::Branch:
+                writeEvent(output, record, trace.numColumns, "B", first);
+                ++numOpen;
+                break;
+            case Event::Backtrack:
+                // the branch may have been overwritten in the ring buffer
+                if (numOpen != 0) {
+                    writeEvent(output, record, trace.numColumns, "E", first);
+                    --numOpen;
+                }
+                break;
+            default:
+                writeEvent(output, record, trace.numColumns, "i", first);
+                break;
+        }
+    }
+
+    if (!trace.events.empty()) {
+        auto last = trace.events.back();
+        last.event = Event::Backtrack;
+        last.value = 0;
+        for (; numOpen != 0; --numOpen) {
+            writeEvent(output, last, trace.numColumns, "E", first);
+        }
+    }
+    output << "\n]}\n";
+}
+
+}  // namespace trace
+
+}  // namespace sudoku
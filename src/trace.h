@@ -0,0 +1,147 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+
+namespace sudoku
+{
+
+/** Tracing the steps of the propagation and the search of a solver.
+ *
+ *  The sink of a BasicSolver is its second template parameter. The
+ *  default NullSink disables every hook at compile time, so the solvers
+ *  of the rest of the program contain no trace of tracing. A solver with
+ *  a RingBuffer keeps its latest events, which can be written to a file
+ *  and turned into Chrome trace JSON later, see writeChromeJson().
+ *
+ *  A sink has a `static constexpr bool enabled` and a member function
+ *  `record(Event event, size_t cell, char value)`, `cell` being the index
+ *  of a cell row by row (noCell for the events of no particular cell) and
+ *  `value` its symbol, or 0 when there is none. */
+namespace trace
+{
+
+const size_t noCell = 0xffff;
+
+enum class Event: std::uint8_t
+{
+    /// a round of propagation starts: fixed values are erased from their peers
+    Pass,
+    /// a potential value was erased from a cell
+    Eliminate,
+    /// a cell was fixed because a single potential value was left
+    NakedSingle,
+    /// a cell was fixed because a value fits nowhere else in one of its units
+    HiddenSingle,
+    /// the search tries a value for a cell
+    Branch,
+    /// the search undoes the last branch it tried
+    Backtrack,
+    /// the propagation ran into a cell or a unit without a value
+    Contradiction,
+    /// every cell is fixed
+    Solution,
+};
+
+/** The name of `event` in the output of writeChromeJson(). */
+const char* nameOf(Event event);
+
+/** The sink of a solver that isn't traced. */
+struct NullSink
+{
+    static constexpr bool enabled = false;
+
+    void record(Event, size_t, char)
+    {}
+};
+
+/** An event with the time it happened at, 16 bytes. */
+struct Record
+{
+    /// since the sink was created or cleared
+    std::uint64_t nanoseconds;
+    std::uint16_t cell;
+    /// the number of branches the search is in
+    std::uint16_t depth;
+    Event event;
+    char value;
+};
+
+/** A sink keeping the latest `capacity` events, overwriting the oldest.
+ *
+ *  Recording an event costs a read of the clock and a store, the buffer
+ *  is allocated once by the constructor. */
+class RingBuffer
+{
+public:
+    static constexpr bool enabled = true;
+    static const size_t defaultCapacity = 1 << 18;
+
+    explicit RingBuffer(size_t capacity = defaultCapacity);
+
+    void record(Event event, size_t cell, char value)
+    {
+        if (event == Event::Backtrack) {
+            --depth;
+        }
+        auto& record = records[numRecorded % records.size()];
+        record.nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+        record.cell = static_cast<std::uint16_t>(cell);
+        record.depth = depth;
+        record.event = event;
+        record.value = value;
+        ++numRecorded;
+        if (event == Event::Branch) {
+            ++depth;
+        }
+    }
+
+    void clear();
+
+    /** The events kept, oldest first. */
+    std::vector<Record> events() const;
+
+    /** The events recorded but overwritten since. */
+    std::uint64_t numDropped() const;
+
+    /** Write the events kept in the binary format of read(), for a grid of
+     *  `numColumns` columns. */
+    void write(std::ostream& output, size_t numColumns) const;
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    std::vector<Record> records;
+    std::uint64_t numRecorded = 0;
+    std::uint16_t depth = 0;
+    clock::time_point start;
+};
+
+/** The contents of a file of RingBuffer::write(). */
+struct Trace
+{
+    size_t numColumns = 0;
+    std::uint64_t numDropped = 0;
+    std::vector<Record> events;
+};
+
+/** Read a trace written by RingBuffer::write(); returns false if the input
+ *  is not one, or if it holds fewer events than its header claims. The
+ *  format is that of the machine that wrote it. */
+bool read(std::istream& input, Trace& trace);
+
+/** Write `trace` as Chrome trace JSON, for chrome://tracing or Perfetto.
+ *
+ *  Every branch of the search is a slice lasting until its backtrack, so
+ *  the slices nest like the search tree; the other events are instants
+ *  within them. Branches still open at the end, like those leading to the
+ *  solution, are closed at the last event. */
+void writeChromeJson(const Trace& trace, std::ostream& output);
+
+}  // namespace trace
+
+}  // namespace sudoku
@@ -6,15 +6,18 @@ namespace sudoku
 namespace types
 {
 
-state_t::state_t()
-{}
-
-void state_t::erase()
+template<size_t BoxSize>
+void basic_state_t<BoxSize>::erase()
 {
-    this->cells.clear();
+    this->cells = cells_t();
     this->remaining = 0;
 }
 
+template struct basic_state_t<2>;
+template struct basic_state_t<3>;
+template struct basic_state_t<4>;
+template struct basic_state_t<5>;
+
 }  // namespace types
 
 }  // namespace sudoku
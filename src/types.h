@@ -1,28 +1,155 @@
 #pragma once
 
-#include <unordered_set>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
 #include <vector>
 
+#include "constants.h"
+
 namespace sudoku
 {
 
 namespace types
 {
 
+/** The set of potential values of a single cell of a grid with boxes of
+ *  `BoxSize` x `BoxSize` cells.
+ *
+ *  The values are stored as a bit mask, bit `k` standing for the value
+ *  constants::Grid::symbol(k), so every query is a couple of bit operations
+ *  without any hashing or heap allocation. The mask is as narrow as the
+ *  number of values allows. */
+template<size_t BoxSize>
+class basic_cell_t
+{
+    using grid = constants::Grid<BoxSize>;
+public:
+    using mask_t = std::conditional_t<(grid::numValues <= 16), std::uint16_t, std::uint32_t>;
+
+    class const_iterator
+    {
+        mask_t remaining;
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = char;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const char*;
+        using reference = char;
+
+        explicit const_iterator(mask_t remaining = 0): remaining(remaining)
+        {}
+
+        char operator*() const
+        {
+            return grid::symbol(std::countr_zero(remaining));
+        }
+
+        const_iterator& operator++()
+        {
+            remaining &= remaining - 1;
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            auto previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const const_iterator&) const = default;
+    };
+
+    basic_cell_t() = default;
+
+    explicit basic_cell_t(mask_t mask): mask(mask)
+    {}
+
+    /** The raw mask, bit `k` standing for the value constants::Grid::symbol(k). */
+    mask_t bits() const
+    {
+        return mask;
+    }
+
+    size_t size() const
+    {
+        return std::popcount(mask);
+    }
+
+    bool empty() const
+    {
+        return mask == 0;
+    }
+
+    size_t count(char value) const
+    {
+        return (mask >> grid::indexOf(value)) & 1;
+    }
+
+    void emplace(char value)
+    {
+        mask |= maskOfValue(value);
+    }
+
+    size_t erase(char value)
+    {
+        const auto erased = count(value);
+        mask &= ~maskOfValue(value);
+        return erased;
+    }
+
+    void clear()
+    {
+        mask = 0;
+    }
+
+    /** The value of a cell that has exactly one potential value. */
+    char single() const
+    {
+        return grid::symbol(std::countr_zero(mask));
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator(mask);
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator();
+    }
+
+    bool operator==(const basic_cell_t&) const = default;
+
+private:
+    static mask_t maskOfValue(char value)
+    {
+        return static_cast<mask_t>(mask_t(1) << grid::indexOf(value));
+    }
+
+    mask_t mask = 0;
+};
+
 using board_t = std::vector<std::vector<char>>;
-using cell_t = std::unordered_set<char>;
-using cells_t = std::vector<std::vector<cell_t>>;
-using remaining_t = size_t;
+using remaining_t = std::uint16_t;
 using percent_t = double;
 
-struct state_t
+/** The complete state of the solver: the potential values of every cell
+ *  and the number of cells that are still unknown.
+ *
+ *  The state is a flat block of memory (a mask per cell and a counter),
+ *  so taking a snapshot or restoring one is a single memcpy. */
+template<size_t BoxSize>
+struct basic_state_t
 {
-    state_t();
-    ~state_t() = default;
-    state_t(const state_t&) = default;
-    state_t& operator=(const state_t&) = default;
-    state_t(state_t&&) = default;
-    state_t& operator=(state_t&&) = default;
+    using grid = constants::Grid<BoxSize>;
+    using cell_t = basic_cell_t<BoxSize>;
+    using row_t = std::array<cell_t, grid::numColumns>;
+    using cells_t = std::array<row_t, grid::numRows>;
 
     void erase();
 
@@ -30,6 +157,14 @@ struct state_t
     remaining_t remaining = 0;
 };
 
+// the classic 9x9 grid
+using cell_t = basic_cell_t<constants::boxSize>;
+using state_t = basic_state_t<constants::boxSize>;
+using row_t = state_t::row_t;
+using cells_t = state_t::cells_t;
+
+static_assert(std::is_trivially_copyable_v<state_t>);
+
 }  // namespace types
 
 }  // namespace sudoku
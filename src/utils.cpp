@@ -9,13 +9,18 @@ namespace sudoku
 namespace utils
 {
 
-char getSingleCellValue(const types::cell_t& cell)
+template<size_t BoxSize>
+char getSingleCellValue(const types::basic_cell_t<BoxSize>& cell)
 {
     assert(cell.size() == 1);
-    auto it = cell.begin();
-    return *it;
+    return cell.single();
 }
 
+template char getSingleCellValue(const types::basic_cell_t<2>& cell);
+template char getSingleCellValue(const types::basic_cell_t<3>& cell);
+template char getSingleCellValue(const types::basic_cell_t<4>& cell);
+template char getSingleCellValue(const types::basic_cell_t<5>& cell);
+
 }  // namespace utils
 
 }  // namespace sudoku
@@ -8,7 +8,8 @@ namespace sudoku
 namespace utils
 {
 
-char getSingleCellValue(const types::cell_t& cell);
+template<size_t BoxSize>
+char getSingleCellValue(const types::basic_cell_t<BoxSize>& cell);
 
 }  // namespace utils
 
@@ -0,0 +1,199 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "parser.h"
+#include "session.h"
+#include "solver.h"
+
+
+namespace sudoku
+{
+
+namespace test
+{
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition) {
+        std::cerr << "FAILED: " << what << '\n';
+        ++failures;
+    }
+}
+
+types::board_t parse(std::string_view text)
+{
+    types::board_t board;
+    parser::Error error;
+    if (!parser::parseBoard(text, board, error)) {
+        std::cerr << "Can't parse a board of the test: " << error.message << '\n';
+        std::exit(EXIT_FAILURE);
+    }
+    return board;
+}
+
+/** Whether every row, column and box of a full board holds every value once. */
+template<size_t BoxSize>
+bool isSolution(const std::string& values)
+{
+    using grid = constants::Grid<BoxSize>;
+    if (values.size() != grid::numElements) {
+        return false;
+    }
+    for (size_t unit = 0; unit < grid::numRows; ++unit) {
+        std::string row, column, box;
+        for (size_t k = 0; k < grid::numColumns; ++k) {
+            row += values[unit * grid::numColumns + k];
+            column += values[k * grid::numColumns + unit];
+            const auto i = (unit / BoxSize) * BoxSize + k / BoxSize;
+            const auto j = (unit % BoxSize) * BoxSize + k % BoxSize;
+            box += values[i * grid::numColumns + j];
+        }
+        for (auto* cells: {&row, &column, &box}) {
+            for (size_t value = 0; value < grid::numValues; ++value) {
+                if (cells->find(constants::symbols[value]) == std::string::npos) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/** A search stopped by a limit leaves the solver ready for another one,
+ *  which gets all of its budget. */
+void testRetryAfterBudget()
+{
+    auto board = parse("800000000003600000070090200050007000000045700000100030001000068008500010090000400");
+    Solver solver(board);
+
+    Solver::Limits limits;
+    limits.maxBranches = 3;
+    check(solver.solve(limits) == Solver::Status::OutOfBudget, "a tiny budget runs out");
+    const auto branches = solver.stats().branchesTried;
+    check(branches == 3, "the search spends its budget of branches");
+    check(solver.solve(limits) == Solver::Status::OutOfBudget, "the same budget runs out again");
+    check(solver.stats().branchesTried == 2 * branches, "the retry spends the same budget again");
+
+    limits.maxBranches = 0;
+    limits.maxPropagations = 1;
+    check(solver.solve(limits) == Solver::Status::OutOfBudget, "a tiny propagation budget runs out");
+    check(solver.stats().branchesTried > 2 * branches, "the givens don't count against the propagation budget");
+    limits.maxPropagations = 0;
+
+    limits.maxBranches = 1000000;
+    check(solver.solve(limits) == Solver::Status::Solved, "the retry with a larger budget solves");
+    std::string values;
+    solver.appendValues(values);
+    check(isSolution<3>(values), "the retry finds a valid solution");
+}
+
+/** The potential values of every cell of a session, row by row. */
+std::vector<Session::cell_t> candidates(const Session& session)
+{
+    using grid = constants::Grid<constants::boxSize>;
+    std::vector<Session::cell_t> cells;
+    for (size_t row = 0; row < grid::numRows; ++row) {
+        for (size_t column = 0; column < grid::numColumns; ++column) {
+            cells.push_back(session.candidates(row, column));
+        }
+    }
+    return cells;
+}
+
+/** Clearing a value gives back the potential values from before it. */
+void testSessionPlaceAndClear()
+{
+    Session session(parse("800000000003600000070090200050007000000045700000100030001000068008500010090000400"));
+    const auto before = candidates(session);
+    const auto value = *session.candidates(0, 1).begin();
+
+    check(session.place(0, 1, value), "a value is placed in an unknown cell");
+    check(session.candidates(0, 1).size() == 1, "the placed cell has a single value");
+    check(session.candidates(0, 1).count(value) == 1, "the placed cell has the placed value");
+    check(candidates(session) != before, "the placement is propagated");
+
+    check(session.clear(0, 1), "the placed value is cleared");
+    check(candidates(session) == before, "clearing restores the potential values");
+    check(!session.clear(0, 1), "a cleared cell has nothing to clear");
+    check(!session.place(0, 0, value), "a given can't be replaced");
+}
+
+/** A value that contradicts a given makes the session inconsistent until
+ *  it is cleared. */
+void testSessionConflict()
+{
+    Session session(parse("800000000003600000070090200050007000000045700000100030001000068008500010090000400"));
+    check(session.isConsistent(), "the givens are consistent");
+
+    check(session.place(0, 1, '8'), "a conflicting value is placed");
+    check(!session.isConsistent(), "a conflicting value makes the session inconsistent");
+    std::string values(constants::Grid<constants::boxSize>::numElements, '.');
+    check(!session.solve(values.data()), "an inconsistent session has no solution");
+
+    check(session.clear(0, 1), "the conflicting value is cleared");
+    check(session.isConsistent(), "clearing the conflict makes the session consistent again");
+}
+
+/** Solving a session after some edits finds the solution of the board. */
+void testSessionSolve()
+{
+    auto board = parse("800000000003600000070090200050007000000045700000100030001000068008500010090000400");
+    Solver solver(board);
+    check(solver.trySolve(), "the solver solves the board");
+    std::string expected;
+    solver.appendValues(expected);
+
+    Session session(board);
+    session.place(0, 1, expected[1]);
+    session.place(8, 8, expected[80]);
+    session.place(4, 4, expected[40]);
+    session.clear(8, 8);
+    std::string values(expected.size(), '.');
+    check(session.solve(values.data()), "the session solves the edited board");
+    check(values == expected, "the session finds the solution of the solver");
+    check(session.candidates(8, 8).size() > 1, "solving leaves the session as it was");
+}
+
+/** Every branch of a 25x25 board that runs out of time leaves the worklist
+ *  empty, however many values its cell has. */
+void testTimeoutOnLargeBoard()
+{
+    auto board = parse(std::string(constants::Grid<5>::numElements, '.'));
+    BasicSolver<5> solver(board);
+
+    Solver::Limits limits;
+    limits.deadline = std::chrono::steady_clock::now();
+    check(solver.solve(limits) == Solver::Status::TimedOut, "a past deadline times out");
+
+    limits.deadline.reset();
+    limits.maxBranches = 1000000;
+    check(solver.solve(limits) == Solver::Status::Solved, "the retry without a deadline solves");
+    std::string values;
+    solver.appendValues(values);
+    check(isSolution<5>(values), "the retry finds a valid solution");
+}
+
+}  // namespace test
+
+}  // namespace sudoku
+
+int main()
+{
+    sudoku::test::testRetryAfterBudget();
+    sudoku::test::testTimeoutOnLargeBoard();
+    sudoku::test::testSessionPlaceAndClear();
+    sudoku::test::testSessionConflict();
+    sudoku::test::testSessionSolve();
+
+    if (sudoku::test::failures != 0) {
+        std::cerr << sudoku::test::failures << " checks failed\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "All checks passed\n";
+    return EXIT_SUCCESS;
+}